@@ -8,351 +8,4522 @@
 #include <iostream>
 #include <sstream>
 #include <vector>
+#include <array>
 #include <map>
 #include <algorithm>
+#include <charconv>
+#include <type_traits>
+#include <locale>
+#include <cctype>
+#include <cstdint>
+#include <limits>
+#include <cstring>
+#include <string_view>
+#include <memory>
+#include <functional>
+#include <unordered_set>
+#include <unordered_map>
+#include <stdexcept>
+#include <fstream>
+#include <filesystem>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define TXMLCONFIG_HAS_MMAP 1
+#endif
+
+// optional sources, each one adds a library to link against:
+// TXMLCONFIG_WITH_TFILE URLs through TFile (RIO), TXMLCONFIG_WITH_ZLIB .gz (-lz), TXMLCONFIG_WITH_ZSTD .zst (-lzstd)
+#ifdef TXMLCONFIG_WITH_TFILE
+#include "TFile.h"
+#endif
+#ifdef TXMLCONFIG_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef TXMLCONFIG_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+/**
+ * @brief Read only contents of a whole file, memory mapped where the platform supports it
+ * Mapped pages come straight from the page cache, so processes on a host loading the same file share them.
+ * Elsewhere the file is read into a private buffer.
+ */
+class TXmlConfigMappedFile {
+public:
+    TXmlConfigMappedFile( const std::string &filename ) {
+#ifdef TXMLCONFIG_HAS_MMAP
+        const int fd = ::open( filename.c_str(), O_RDONLY );
+        if ( fd < 0 )
+            return;
+        struct stat st;
+        if ( 0 == ::fstat( fd, &st ) && st.st_size > 0 ) {
+            void *addr = ::mmap( nullptr, static_cast<size_t>( st.st_size ), PROT_READ, MAP_PRIVATE, fd, 0 );
+            if ( addr != MAP_FAILED ) {
+                mData = static_cast<const char *>( addr );
+                mSize = static_cast<size_t>( st.st_size );
+                mMapped = true;
+            }
+        }
+        ::close( fd );
+#else
+        std::ifstream in( filename, std::ios::binary | std::ios::ate );
+        if ( !in )
+            return;
+        mBuffer.resize( static_cast<size_t>( in.tellg() ) );
+        in.seekg( 0 );
+        in.read( &mBuffer[0], mBuffer.size() );
+        if ( in && !mBuffer.empty() ) {
+            mData = mBuffer.data();
+            mSize = mBuffer.size();
+        }
+#endif
+    }
+
+    ~TXmlConfigMappedFile() {
+#ifdef TXMLCONFIG_HAS_MMAP
+        if ( mMapped )
+            ::munmap( const_cast<char *>( mData ), mSize );
+#endif
+    }
+
+    TXmlConfigMappedFile( const TXmlConfigMappedFile & ) = delete;
+    TXmlConfigMappedFile &operator=( const TXmlConfigMappedFile & ) = delete;
+
+    bool isOpen() const { return mData != nullptr; }
+    std::string_view data() const { return std::string_view( mData, mSize ); }
+
+protected:
+    const char *mData = nullptr;
+    size_t mSize = 0;
+    bool mMapped = false;
+    std::string mBuffer; // used when mmap is not available
+};
+
+/**
+ * @brief Reads a whole document from a local file or a URL, decompressing .gz and .zst on the fly
+ * URLs (anything with "://", e.g. root:// or https://) are opened in raw mode through ROOT's TFile plugins.
+ * Compressed input is read and inflated chunk by chunk, so only the decompressed document is held in memory.
+ * URLs need TXMLCONFIG_WITH_TFILE, .gz TXMLCONFIG_WITH_ZLIB and .zst TXMLCONFIG_WITH_ZSTD, without them fetch fails.
+ */
+class TXmlConfigSource {
+public:
+    static bool isRemote( const std::string &name ) {
+        return name.find( "://" ) != std::string::npos && name.compare( 0, 7, "file://" ) != 0;
+    }
+
+    static bool isCompressed( const std::string &name ) {
+        return endsWith( withoutQuery( name ), ".gz" ) || endsWith( withoutQuery( name ), ".zst" );
+    }
+
+    /**
+     * @brief read (and decompress) the document name into content
+     * 
+     * @return true on success, false if the source can not be read, is corrupt or its compression is not available
+     */
+    static bool fetch( const std::string &name, std::string &content ) {
+        content.clear();
+        if ( isRemote( name ) ) {
+#ifdef TXMLCONFIG_WITH_TFILE
+            std::unique_ptr<TFile> file( TFile::Open( ( name + ( name.find( '?' ) == std::string::npos ? "?" : "&" ) + "filetype=raw" ).c_str() ) );
+            if ( !file || file->IsZombie() )
+                return false;
+            const Long64_t size = file->GetSize();
+            Long64_t pos = 0;
+            return decode( name, [&]( char *buf, size_t n ) -> long {
+                const Long64_t len = std::min<Long64_t>( static_cast<Long64_t>( n ), size - pos );
+                if ( len <= 0 )
+                    return 0;
+                if ( file->ReadBuffer( buf, pos, static_cast<Int_t>( len ) ) )
+                    return -1;
+                pos += len;
+                return static_cast<long>( len );
+            }, content );
+#else
+            return false;
+#endif
+        }
+
+        std::ifstream in( name.compare( 0, 7, "file://" ) == 0 ? name.substr( 7 ) : name, std::ios::binary );
+        if ( !in )
+            return false;
+        return decode( name, [&]( char *buf, size_t n ) -> long {
+            in.read( buf, static_cast<std::streamsize>( n ) );
+            return in.bad() ? -1 : static_cast<long>( in.gcount() );
+        }, content );
+    }
+
+protected:
+    static constexpr size_t chunkSize = 256 * 1024;
+
+    static std::string withoutQuery( const std::string &name ) {
+        return isRemote( name ) ? name.substr( 0, name.find( '?' ) ) : name;
+    }
+
+    static bool endsWith( const std::string &s, const char *suffix ) {
+        const size_t n = strlen( suffix );
+        return s.size() >= n && 0 == s.compare( s.size() - n, n, suffix );
+    }
+
+    // read( buf, n ) returns the number of bytes read, 0 at the end, -1 on error
+    template <typename R>
+    static bool decode( const std::string &name, R read, std::string &out ) {
+        std::vector<char> in( chunkSize );
+        const std::string plain = withoutQuery( name );
+        if ( endsWith( plain, ".gz" ) ) {
+#ifdef TXMLCONFIG_WITH_ZLIB
+            z_stream zs{};
+            if ( inflateInit2( &zs, 15 + 32 ) != Z_OK ) // 32: gzip or zlib header
+                return false;
+            bool ok = true, done = false;
+            for ( long n; ok && ( n = read( in.data(), in.size() ) ) != 0; ) {
+                if ( n < 0 )
+                    ok = false;
+                zs.next_in = reinterpret_cast<Bytef *>( in.data() );
+                zs.avail_in = static_cast<uInt>( std::max( n, 0L ) );
+                while ( ok && zs.avail_in > 0 ) {
+                    if ( done ) { // concatenated gzip members
+                        inflateReset( &zs );
+                        done = false;
+                    }
+                    const size_t at = out.size();
+                    out.resize( at + chunkSize );
+                    zs.next_out = reinterpret_cast<Bytef *>( &out[ at ] );
+                    zs.avail_out = static_cast<uInt>( chunkSize );
+                    const int rc = inflate( &zs, Z_NO_FLUSH );
+                    out.resize( out.size() - zs.avail_out );
+                    if ( rc == Z_STREAM_END )
+                        done = true;
+                    else if ( rc != Z_OK && rc != Z_BUF_ERROR )
+                        ok = false;
+                }
+            }
+            // drain output still pending for the last input
+            while ( ok && !done ) {
+                const size_t at = out.size();
+                out.resize( at + chunkSize );
+                zs.next_out = reinterpret_cast<Bytef *>( &out[ at ] );
+                zs.avail_out = static_cast<uInt>( chunkSize );
+                const int rc = inflate( &zs, Z_NO_FLUSH );
+                out.resize( out.size() - zs.avail_out );
+                if ( rc == Z_STREAM_END )
+                    done = true;
+                else if ( rc != Z_OK || zs.avail_out == chunkSize )
+                    ok = false; // truncated
+            }
+            inflateEnd( &zs );
+            return ok;
+#else
+            return false;
+#endif
+        }
+        if ( endsWith( plain, ".zst" ) ) {
+#ifdef TXMLCONFIG_WITH_ZSTD
+            std::unique_ptr<ZSTD_DCtx, size_t ( * )( ZSTD_DCtx * )> ctx( ZSTD_createDCtx(), ZSTD_freeDCtx );
+            size_t rc = 1; // > 0 while a frame is incomplete
+            for ( long n; ( n = read( in.data(), in.size() ) ) != 0; ) {
+                if ( n < 0 )
+                    return false;
+                ZSTD_inBuffer ib = { in.data(), static_cast<size_t>( n ), 0 };
+                while ( ib.pos < ib.size ) {
+                    const size_t at = out.size();
+                    out.resize( at + chunkSize );
+                    ZSTD_outBuffer ob = { &out[ at ], chunkSize, 0 };
+                    rc = ZSTD_decompressStream( ctx.get(), &ob, &ib );
+                    out.resize( at + ob.pos );
+                    if ( ZSTD_isError( rc ) )
+                        return false;
+                }
+            }
+            // flush what the decoder still holds
+            while ( rc != 0 ) {
+                ZSTD_inBuffer ib = { nullptr, 0, 0 };
+                const size_t at = out.size();
+                out.resize( at + chunkSize );
+                ZSTD_outBuffer ob = { &out[ at ], chunkSize, 0 };
+                rc = ZSTD_decompressStream( ctx.get(), &ob, &ib );
+                out.resize( at + ob.pos );
+                if ( ZSTD_isError( rc ) || ob.pos == 0 )
+                    return false; // truncated
+            }
+            return true;
+#else
+            return false;
+#endif
+        }
+        for ( long n; ( n = read( in.data(), in.size() ) ) != 0; ) {
+            if ( n < 0 )
+                return false;
+            out.append( in.data(), static_cast<size_t>( n ) );
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Flat storage backend for the mapped config
+ * Nodes live in one contiguous vector in document order. Each node stores only its own
+ * interned path segment and the index of its parent, so the dotted prefixes shared by
+ * many keys are stored once. Lookups hash the full canonical path into an open addressing
+ * table and confirm the match by walking the parent chain. Segments and values are kept
+ * in a chunked arena, so a config costs a few large allocations instead of two per key.
+ */
+class TXmlConfigStore {
+public:
+    static constexpr uint32_t npos = 0xFFFFFFFF;
+
+    struct Node {
+        uint64_t hash = 0;          // FNV-1a hash of the full canonical path
+        const char *seg = "";       // interned segment, including its leading "." or ":"
+        const char *val = nullptr;  // value in the arena, nullptr for implicit (structural only) nodes
+        uint32_t segLen = 0;
+        uint32_t valLen = 0;
+        uint32_t parent = npos;     // index of the parent node, npos only for the root
+        uint32_t index = 0;         // repeated node index, written as "[index]" after seg, 0 for none
+        uint32_t firstChild = npos; // children (attributes and nodes) in document order
+        uint32_t lastChild = npos;
+        uint32_t nextSibling = npos;
+    };
+
+    TXmlConfigStore() { clear(); }
+
+    TXmlConfigStore( const TXmlConfigStore &o ) : mNodes( o.mNodes ), mTable( o.mTable ), mMask( o.mMask ) {
+        // rebase segments and values into our own arena, borrowed values included
+        for ( Node &n : mNodes ) {
+            n.seg = intern( std::string_view( n.seg, n.segLen ) );
+            if ( n.val )
+                n.val = copy( std::string_view( n.val, n.valLen ) );
+        }
+    }
+
+    TXmlConfigStore( TXmlConfigStore &&o ) : TXmlConfigStore() { swap( o ); }
+
+    TXmlConfigStore &operator=( TXmlConfigStore o ) {
+        swap( o );
+        return *this;
+    }
+
+    void swap( TXmlConfigStore &o ) {
+        mNodes.swap( o.mNodes );
+        mTable.swap( o.mTable );
+        std::swap( mMask, o.mMask );
+        mBlocks.swap( o.mBlocks );
+        std::swap( mArenaTop, o.mArenaTop );
+        std::swap( mArenaLeft, o.mArenaLeft );
+        std::swap( mArenaBytes, o.mArenaBytes );
+        mSegments.swap( o.mSegments );
+        mOwners.swap( o.mOwners );
+    }
+
+    /**
+     * @brief remove everything, leaving only the implicit root node
+     */
+    void clear() {
+        mNodes.clear();
+        mTable.assign( 16, npos );
+        mMask = mTable.size() - 1;
+        mBlocks.clear();
+        mArenaTop = nullptr;
+        mArenaLeft = 0;
+        mArenaBytes = 0;
+        mSegments.clear();
+        mOwners.clear();
+
+        Node root;
+        root.hash = hashBasis;
+        mNodes.push_back( root );
+        mTable[ root.hash & mMask ] = 0;
+    }
+
+    /**
+     * @brief continue an FNV-1a hash over some bytes
+     */
+    static constexpr uint64_t hashBytes( uint64_t h, const char *p, size_t n ) {
+        for ( size_t i = 0; i < n; i++ ) {
+            h ^= static_cast<unsigned char>( p[i] );
+            h *= hashPrime;
+        }
+        return h;
+    }
+
+    /**
+     * @brief FNV-1a hash of a full canonical path, as stored in Node::hash
+     */
+    static constexpr uint64_t hashKey( std::string_view key ) {
+        return hashBytes( hashBasis, key.data(), key.size() );
+    }
+
+    /**
+     * @brief write "[index]" into buf
+     * @return size_t number of characters written
+     */
+    static size_t formatIndex( uint32_t index, char *buf ) {
+        buf[0] = '[';
+        char *end = std::to_chars( buf + 1, buf + 12, index ).ptr;
+        *end++ = ']';
+        return end - buf;
+    }
+
+    /**
+     * @brief index of the node at key, including implicit nodes
+     * 
+     * @param key canonical path
+     * @return uint32_t node index or npos if DNE
+     */
+    uint32_t findId( std::string_view key ) const {
+        return findId( key, hashKey( key ) );
+    }
+
+    /**
+     * @brief index of the node at key, with the hash of key already known (see hashKey)
+     */
+    uint32_t findId( std::string_view key, uint64_t h ) const {
+        for ( size_t slot = h & mMask; ; slot = ( slot + 1 ) & mMask ) {
+            const uint32_t id = mTable[ slot ];
+            if ( id == npos )
+                return npos;
+            if ( mNodes[ id ].hash == h && matches( id, key ) )
+                return id;
+        }
+    }
+
+    /**
+     * @brief the node holding a value at key
+     * 
+     * @param key canonical path
+     * @return const Node* node or nullptr if no value is stored at key
+     */
+    const Node *lookup( std::string_view key ) const {
+        const uint32_t id = findId( key );
+        if ( id == npos || mNodes[ id ].val == nullptr )
+            return nullptr;
+        return &mNodes[ id ];
+    }
+
+    size_t count( std::string_view key ) const {
+        return lookup( key ) != nullptr ? 1 : 0;
+    }
+
+    /**
+     * @brief value stored at key
+     * @throws std::out_of_range if key DNE, as std::map::at
+     */
+    std::string_view at( std::string_view key ) const {
+        const Node *n = lookup( key );
+        if ( n == nullptr )
+            throw std::out_of_range( "TXmlConfigStore::at" );
+        return value( *n );
+    }
+
+    static std::string_view value( const Node &n ) {
+        return std::string_view( n.val, n.valLen );
+    }
+
+    /**
+     * @brief Add a child node below parent, or overwrite the value if that path exists
+     * 
+     * @param parent index of the parent node
+     * @param seg segment of the child, with its leading delimiter
+     * @param index repeated node index, 0 for none
+     * @param val value to store
+     * @return uint32_t index of the child node
+     */
+    uint32_t insert( uint32_t parent, std::string_view seg, uint32_t index, std::string_view val ) {
+        const uint32_t id = child( parent, seg, index );
+        assign( mNodes[ id ], val );
+        return id;
+    }
+
+    /**
+     * @brief find or create the child of parent with the given segment and index
+     * a new child is implicit (holds no value) until setValue
+     * 
+     * @param parent index of the parent node
+     * @param seg segment of the child, with its leading delimiter
+     * @param index repeated node index, 0 for none
+     * @return uint32_t index of the child node
+     */
+    uint32_t child( uint32_t parent, std::string_view seg, uint32_t index ) {
+        char buf[16];
+        uint64_t h = hashBytes( mNodes[ parent ].hash, seg.data(), seg.size() );
+        if ( index )
+            h = hashBytes( h, buf, formatIndex( index, buf ) );
+
+        size_t slot = h & mMask;
+        for ( ; mTable[ slot ] != npos; slot = ( slot + 1 ) & mMask ) {
+            const uint32_t id = mTable[ slot ];
+            if ( mNodes[ id ].hash != h )
+                continue;
+            const Node &n = mNodes[ id ];
+            if ( n.parent == parent && n.index == index && std::string_view( n.seg, n.segLen ) == seg )
+                return id;
+            // same text split differently (e.g. ':' inside an element name), compare the full path
+            std::string k = key( parent );
+            k.append( seg.data(), seg.size() );
+            if ( index )
+                k.append( buf, formatIndex( index, buf ) );
+            if ( matches( id, k ) )
+                return id;
+        }
+
+        Node n;
+        n.hash = h;
+        n.seg = intern( seg );
+        n.segLen = static_cast<uint32_t>( seg.size() );
+        n.parent = parent;
+        n.index = index;
+        const uint32_t id = static_cast<uint32_t>( mNodes.size() );
+        mNodes.push_back( n );
+        link( id );
+        mTable[ slot ] = id;
+        if ( mNodes.size() * 2 > mTable.size() )
+            rehash( mTable.size() * 2 );
+        return id;
+    }
+
+    /**
+     * @brief Write the value of an existing node
+     */
+    void setValue( uint32_t id, std::string_view val ) {
+        assign( mNodes[ id ], val );
+    }
+
+    /**
+     * @brief Point the value of an existing node at external memory, without copying
+     * The memory must stay valid as long as the store, see keepAlive
+     */
+    void setValueRef( uint32_t id, std::string_view val ) {
+        mNodes[ id ].val = val.data();
+        mNodes[ id ].valLen = static_cast<uint32_t>( val.size() );
+    }
+
+    /**
+     * @brief Hold a reference to the owner of memory used by setValueRef, released on clear()
+     */
+    void keepAlive( std::shared_ptr<const void> owner ) {
+        mOwners.push_back( owner );
+    }
+
+    /**
+     * @brief Write a value at key, creating implicit parent nodes as needed
+     * 
+     * @param key canonical path
+     * @param val value to store
+     * @return uint32_t index of the node
+     */
+    uint32_t set( std::string_view key, std::string_view val ) {
+        const uint32_t id = makePath( key );
+        assign( mNodes[ id ], val );
+        return id;
+    }
+
+    /**
+     * @brief number of nodes, including the root and implicit nodes
+     */
+    size_t size() const { return mNodes.size(); }
+    const Node &node( uint32_t id ) const { return mNodes[ id ]; }
+
+    /**
+     * @brief whether a node is an attribute (its segment starts with ":")
+     */
+    bool isAttribute( uint32_t id ) const {
+        return mNodes[ id ].segLen > 0 && mNodes[ id ].seg[0] == ':';
+    }
+
+    /**
+     * @brief append the full canonical path of a node to out
+     */
+    void appendKey( uint32_t id, std::string &out ) const {
+        char buf[16];
+        // measure first, then fill from the back while walking up the chain
+        size_t len = 0;
+        for ( uint32_t i = id; mNodes[ i ].parent != npos; i = mNodes[ i ].parent )
+            len += mNodes[ i ].segLen + ( mNodes[ i ].index ? formatIndex( mNodes[ i ].index, buf ) : 0 );
+        const size_t start = out.size();
+        out.resize( start + len );
+        char *end = &out[0] + start + len;
+        for ( ; mNodes[ id ].parent != npos; id = mNodes[ id ].parent ) {
+            const Node &n = mNodes[ id ];
+            if ( n.index ) {
+                const size_t l = formatIndex( n.index, buf );
+                end -= l;
+                memcpy( end, buf, l );
+            }
+            end -= n.segLen;
+            memcpy( end, n.seg, n.segLen );
+        }
+    }
+
+    std::string key( uint32_t id ) const {
+        std::string k;
+        appendKey( id, k );
+        return k;
+    }
+
+    /**
+     * @brief the child of parent with the given segment and index, without creating it
+     * 
+     * @return uint32_t node index, npos if DNE
+     */
+    uint32_t findChild( uint32_t parent, std::string_view seg, uint32_t index ) const {
+        char buf[16];
+        uint64_t h = hashBytes( mNodes[ parent ].hash, seg.data(), seg.size() );
+        if ( index )
+            h = hashBytes( h, buf, formatIndex( index, buf ) );
+        for ( size_t slot = h & mMask; mTable[ slot ] != npos; slot = ( slot + 1 ) & mMask ) {
+            const Node &n = mNodes[ mTable[ slot ] ];
+            if ( n.hash == h && n.parent == parent && n.index == index && std::string_view( n.seg, n.segLen ) == seg )
+                return mTable[ slot ];
+        }
+        return npos;
+    }
+
+    /**
+     * @brief Copy the nodes of o into this store, values in o override existing ones
+     * Nodes are matched by (parent, segment, index), so no full paths are built
+     * 
+     * @param o store to merge in
+     * @param first first node of o to copy the value of, earlier ones are only used as parents
+     * @param last end of the nodes of o to copy
+     */
+    void merge( const TXmlConfigStore &o, size_t first = 0, size_t last = npos ) {
+        // parents always precede their children, so one pass in index order suffices
+        last = std::min( last, o.mNodes.size() );
+        std::vector<uint32_t> ids( last );
+        for ( uint32_t i = 0; i < last; i++ ) {
+            const Node &n = o.mNodes[ i ];
+            ids[ i ] = ( i == 0 ) ? 0 : child( ids[ n.parent ], std::string_view( n.seg, n.segLen ), n.index );
+            if ( n.val && i >= first )
+                assign( mNodes[ ids[ i ] ], std::string_view( n.val, n.valLen ) );
+        }
+    }
+
+    /**
+     * @brief Copy node top of o and everything below it into this store, values in o override existing ones
+     * The ancestors of top are created as implicit nodes, so keys stay the full paths.
+     * The cost follows the size of the subtree, not of o.
+     *
+     * @param o store to merge from
+     * @param top node of o, npos merges nothing
+     */
+    void mergeSubtree( const TXmlConfigStore &o, uint32_t top ) {
+        if ( top == npos )
+            return;
+        std::vector<uint32_t> chain;
+        for ( uint32_t i = top; o.mNodes[ i ].parent != npos; i = o.mNodes[ i ].parent )
+            chain.push_back( i );
+        uint32_t at = 0;
+        for ( auto it = chain.rbegin(); it != chain.rend(); ++it )
+            at = child( at, std::string_view( o.mNodes[ *it ].seg, o.mNodes[ *it ].segLen ), o.mNodes[ *it ].index );
+
+        // children are added in the order of their child list in o, pairs of ( id in o, id here )
+        std::vector<std::pair<uint32_t, uint32_t>> stack( 1, { top, at } );
+        while ( !stack.empty() ) {
+            const std::pair<uint32_t, uint32_t> ids = stack.back();
+            stack.pop_back();
+            const Node &n = o.mNodes[ ids.first ];
+            if ( n.val )
+                assign( mNodes[ ids.second ], std::string_view( n.val, n.valLen ) );
+            const size_t mark = stack.size();
+            for ( uint32_t c = n.firstChild; c != npos; c = o.mNodes[ c ].nextSibling )
+                stack.emplace_back( c, child( ids.second, std::string_view( o.mNodes[ c ].seg, o.mNodes[ c ].segLen ), o.mNodes[ c ].index ) );
+            std::reverse( stack.begin() + mark, stack.end() );
+        }
+    }
+
+    /**
+     * @brief fast 64 bit checksum, one multiply per 8 bytes
+     */
+    static uint64_t checksum( const char *p, size_t n ) {
+        uint64_t h = hashBasis ^ n;
+        uint64_t w;
+        size_t i = 0;
+        for ( ; i + 8 <= n; i += 8 ) {
+            memcpy( &w, p + i, 8 );
+            h = ( h ^ w ) * hashPrime;
+            h ^= h >> 29;
+        }
+        return hashBytes( h, p + i, n - i );
+    }
+
+    /**
+     * @brief Serialize the store into a versioned, checksummed binary snapshot
+     * Layout: SnapshotHeader, node records, the hash table as is, then a string blob
+     * holding each interned segment once and every value. All sections are 8 byte aligned,
+     * so a snapshot can be used straight from a memory mapping.
+     * 
+     * @return std::string the snapshot, empty if the store is too large for 32 bit offsets
+     */
+    std::string snapshot() const {
+        std::string strings;
+        std::unordered_map<const char *, uint32_t> segOffsets;
+        std::vector<SnapshotNode> records( mNodes.size() );
+        for ( size_t i = 0; i < mNodes.size(); i++ ) {
+            const Node &n = mNodes[ i ];
+            SnapshotNode &r = records[ i ];
+            r.hash = n.hash;
+            auto it = segOffsets.find( n.seg );
+            if ( it == segOffsets.end() ) {
+                it = segOffsets.emplace( n.seg, static_cast<uint32_t>( strings.size() ) ).first;
+                strings.append( n.seg, n.segLen );
+            }
+            r.seg = it->second;
+            r.segLen = n.segLen;
+            r.val = n.val ? static_cast<uint32_t>( strings.size() ) : npos;
+            r.valLen = n.valLen;
+            if ( n.val )
+                strings.append( n.val, n.valLen );
+            r.parent = n.parent;
+            r.index = n.index;
+            if ( strings.size() >= npos )
+                return std::string();
+        }
+
+        SnapshotHeader h;
+        h.nodes = static_cast<uint32_t>( records.size() );
+        h.slots = static_cast<uint32_t>( mTable.size() );
+        h.strings = strings.size();
+        const size_t nodeBytes = records.size() * sizeof( SnapshotNode );
+        const size_t tableBytes = ( mTable.size() * sizeof( uint32_t ) + 7 ) & ~size_t( 7 );
+
+        std::string out( sizeof( SnapshotHeader ) + nodeBytes + tableBytes + strings.size(), '\0' );
+        char *payload = &out[ sizeof( SnapshotHeader ) ];
+        memcpy( payload, records.data(), nodeBytes );
+        memcpy( payload + nodeBytes, mTable.data(), mTable.size() * sizeof( uint32_t ) );
+        memcpy( payload + nodeBytes + tableBytes, strings.data(), strings.size() );
+        h.checksum = checksum( payload, out.size() - sizeof( SnapshotHeader ) );
+        memcpy( &out[0], &h, sizeof( SnapshotHeader ) );
+        return out;
+    }
+
+    /**
+     * @brief Replace the contents with a snapshot written by snapshot()
+     * Segments and values are used in place, data must stay valid while owner is alive
+     * 
+     * @param data the snapshot
+     * @param owner keeps data alive, held until clear()
+     * @return true on success, false (and an empty store) if data is not a valid snapshot
+     */
+    bool restore( std::string_view data, std::shared_ptr<const void> owner ) {
+        clear();
+        SnapshotHeader h;
+        const SnapshotHeader expected;
+        if ( data.size() < sizeof( SnapshotHeader ) )
+            return false;
+        memcpy( &h, data.data(), sizeof( SnapshotHeader ) );
+        if ( 0 != memcmp( h.magic, expected.magic, sizeof( h.magic ) ) || h.version != expected.version ||
+             h.byteOrder != expected.byteOrder || h.nodes == 0 || h.slots < 2 * h.nodes || ( h.slots & ( h.slots - 1 ) ) )
+            return false;
+
+        const size_t nodeBytes = size_t( h.nodes ) * sizeof( SnapshotNode );
+        const size_t tableBytes = ( size_t( h.slots ) * sizeof( uint32_t ) + 7 ) & ~size_t( 7 );
+        const char *payload = data.data() + sizeof( SnapshotHeader );
+        if ( data.size() != sizeof( SnapshotHeader ) + nodeBytes + tableBytes + h.strings ||
+             h.checksum != checksum( payload, data.size() - sizeof( SnapshotHeader ) ) )
+            return false;
+
+        const char *strings = payload + nodeBytes + tableBytes;
+        mNodes.resize( h.nodes );
+        for ( size_t i = 0; i < h.nodes; i++ ) {
+            SnapshotNode r;
+            memcpy( &r, payload + i * sizeof( SnapshotNode ), sizeof( SnapshotNode ) );
+            // the checksum only catches damage, not a writer that got the layout wrong
+            const bool inside = size_t( r.seg ) + r.segLen <= h.strings &&
+                                ( r.val == npos || size_t( r.val ) + r.valLen <= h.strings );
+            const bool ordered = ( i == 0 ) ? r.parent == npos : r.parent < i;
+            if ( !inside || !ordered ) {
+                clear();
+                return false;
+            }
+            Node &n = mNodes[ i ];
+            n.hash = r.hash;
+            n.seg = strings + r.seg;
+            n.segLen = r.segLen;
+            n.val = ( r.val == npos ) ? nullptr : strings + r.val;
+            n.valLen = r.valLen;
+            n.parent = r.parent;
+            n.index = r.index;
+            if ( i > 0 )
+                link( static_cast<uint32_t>( i ) );
+            if ( n.segLen > 0 )
+                mSegments.insert( std::string_view( n.seg, n.segLen ) ); // later set() calls reuse them
+        }
+        mTable.resize( h.slots );
+        memcpy( mTable.data(), payload + nodeBytes, size_t( h.slots ) * sizeof( uint32_t ) );
+        // every node in one slot, which also leaves the empty slots that end each probe
+        size_t occupied = 0, outside = 0;
+        for ( uint32_t id : mTable ) {
+            occupied += ( id != npos );
+            outside += ( id != npos && id >= h.nodes );
+        }
+        if ( occupied != h.nodes || outside > 0 ) {
+            clear();
+            return false;
+        }
+        mMask = mTable.size() - 1;
+        keepAlive( owner );
+        return true;
+    }
+
+    /**
+     * @brief Memory held by the store, see TXmlConfig::memoryUsage
+     */
+    struct Usage {
+        size_t nodes = 0;        // all nodes, including the root and nodes only implied by deeper paths
+        size_t entries = 0;      // nodes holding a value
+        size_t placeholders = 0; // entries holding the placeholder of elements without text
+        size_t keyBytes = 0;     // distinct path segments
+        size_t valueBytes = 0;   // every value counted separately, also those borrowed from a mapped file
+        size_t arenaBytes = 0;   // allocated for segments and values
+        size_t nodeBytes = 0;    // node records
+        size_t indexBytes = 0;   // hash table and segment set
+        size_t total() const { return arenaBytes + nodeBytes + indexBytes; }
+    };
+
+    Usage usage( std::string_view placeholder ) const {
+        Usage u;
+        u.nodes = mNodes.size();
+        for ( const Node &n : mNodes ) {
+            if ( n.val == nullptr )
+                continue;
+            u.entries++;
+            u.valueBytes += n.valLen;
+            if ( value( n ) == placeholder )
+                u.placeholders++;
+        }
+        for ( std::string_view seg : mSegments )
+            u.keyBytes += seg.size();
+        u.arenaBytes = mArenaBytes;
+        u.nodeBytes = mNodes.capacity() * sizeof( Node );
+        u.indexBytes = allocatedBytes() - u.arenaBytes - u.nodeBytes;
+        return u;
+    }
+
+    /**
+     * @brief Rebuild the arena as one block holding every distinct segment and value once
+     * Borrowed values are copied in and their owners released. Node ids stay the same,
+     * views of the old values are invalidated.
+     */
+    void compact() {
+        // new offset of every distinct string, keyed by views of the old memory
+        std::unordered_map<std::string_view, size_t> offsets;
+        size_t total = 0;
+        auto place = [&]( const char *p, uint32_t len ) {
+            if ( len > 0 && offsets.emplace( std::string_view( p, len ), total ).second )
+                total += len;
+        };
+        for ( const Node &n : mNodes ) {
+            place( n.seg, n.segLen );
+            if ( n.val != nullptr )
+                place( n.val, n.valLen );
+        }
+        std::unique_ptr<char[]> block( new char[ std::max<size_t>( total, 1 ) ] );
+        for ( const auto &kv : offsets )
+            memcpy( block.get() + kv.second, kv.first.data(), kv.first.size() );
+        auto moved = [&]( const char *p, uint32_t len ) -> const char * {
+            return len > 0 ? block.get() + offsets.find( std::string_view( p, len ) )->second : "";
+        };
+        mSegments.clear();
+        for ( Node &n : mNodes ) {
+            n.seg = moved( n.seg, n.segLen );
+            if ( n.segLen > 0 )
+                mSegments.insert( std::string_view( n.seg, n.segLen ) );
+            if ( n.val != nullptr )
+                n.val = moved( n.val, n.valLen );
+        }
+
+        mBlocks.clear();
+        mArenaTop = block.get() + total;
+        mArenaLeft = 0;
+        mArenaBytes = total;
+        mBlocks.push_back( std::move( block ) );
+        mOwners.clear();
+        mNodes.shrink_to_fit();
+        size_t table = 16;
+        while ( mNodes.size() * 2 > table )
+            table *= 2;
+        mTable.clear();
+        mTable.shrink_to_fit();
+        rehash( table );
+    }
+
+    /**
+     * @brief total heap bytes held by the store
+     */
+    size_t allocatedBytes() const {
+        // unordered_set cost estimated as one bucket pointer plus one node per segment
+        return mNodes.capacity() * sizeof( Node ) +
+               mTable.capacity() * sizeof( uint32_t ) +
+               mBlocks.capacity() * sizeof( std::unique_ptr<char[]> ) +
+               mArenaBytes +
+               mSegments.bucket_count() * sizeof( void * ) +
+               mSegments.size() * ( sizeof( std::string_view ) + 2 * sizeof( void * ) );
+    }
+
+protected:
+    // binary snapshot layout, see snapshot()
+    struct SnapshotHeader {
+        char magic[8] = { 'T', 'X', 'M', 'L', 'C', 'F', 'G', '\0' };
+        uint32_t version = 1;
+        uint32_t byteOrder = 0x01020304; // written in host order, rejected on mismatch
+        uint32_t nodes = 0;
+        uint32_t slots = 0;
+        uint64_t strings = 0;
+        uint64_t checksum = 0;
+        uint64_t reserved = 0;
+    };
+    struct SnapshotNode {
+        uint64_t hash;
+        uint32_t seg, segLen;
+        uint32_t val, valLen; // val is npos for implicit nodes
+        uint32_t parent, index;
+    };
+
+    static constexpr uint64_t hashBasis = 14695981039346656037ULL;
+    static constexpr uint64_t hashPrime = 1099511628211ULL;
+    static constexpr size_t blockSize = 64 * 1024;
+
+    /**
+     * @brief whether the chain of node id spells out key exactly
+     */
+    bool matches( uint32_t id, std::string_view key ) const {
+        size_t end = key.size();
+        char buf[16];
+        for ( ; mNodes[ id ].parent != npos; id = mNodes[ id ].parent ) {
+            const Node &n = mNodes[ id ];
+            if ( n.index ) {
+                const size_t len = formatIndex( n.index, buf );
+                if ( end < len || 0 != memcmp( key.data() + end - len, buf, len ) )
+                    return false;
+                end -= len;
+            }
+            if ( end < n.segLen || 0 != memcmp( key.data() + end - n.segLen, n.seg, n.segLen ) )
+                return false;
+            end -= n.segLen;
+        }
+        return end == 0;
+    }
+
+    /**
+     * @brief find or create the node for key, creating implicit nodes for missing parents
+     * attributes split at the first ":", elements at the last "."
+     */
+    uint32_t makePath( std::string_view key ) {
+        const uint32_t found = findId( key );
+        if ( found != npos )
+            return found;
+
+        size_t pos = key.find( ':' );
+        if ( pos == std::string_view::npos ) {
+            pos = key.rfind( '.' );
+            if ( pos == std::string_view::npos )
+                pos = 0;
+        }
+        const uint32_t parent = makePath( key.substr( 0, pos ) );
+        std::string_view seg = key.substr( pos );
+
+        // a trailing "[n]" becomes the repeated node index if it formats back identically
+        uint32_t index = 0;
+        const size_t lb = seg.rfind( '[' );
+        if ( seg.size() > 2 && seg.back() == ']' && lb != std::string_view::npos && lb > 0 ) {
+            uint32_t v = 0;
+            const char *first = seg.data() + lb + 1;
+            const char *last = seg.data() + seg.size() - 1;
+            auto res = std::from_chars( first, last, v );
+            if ( res.ec == std::errc() && res.ptr == last && v > 0 && *first != '0' ) {
+                index = v;
+                seg = seg.substr( 0, lb );
+            }
+        }
+        return child( parent, seg, index );
+    }
+
+    /**
+     * @brief append node id to the child list of its parent
+     */
+    void link( uint32_t id ) {
+        Node &parent = mNodes[ mNodes[ id ].parent ];
+        if ( parent.lastChild == npos )
+            parent.firstChild = id;
+        else
+            mNodes[ parent.lastChild ].nextSibling = id;
+        parent.lastChild = id;
+    }
+
+    void rehash( size_t n ) {
+        mTable.assign( n, npos );
+        mMask = n - 1;
+        for ( uint32_t id = 0; id < mNodes.size(); id++ ) {
+            size_t slot = mNodes[ id ].hash & mMask;
+            while ( mTable[ slot ] != npos )
+                slot = ( slot + 1 ) & mMask;
+            mTable[ slot ] = id;
+        }
+    }
+
+    void assign( Node &n, std::string_view val ) {
+        // values are never overwritten in place so views handed out stay valid
+        n.val = copy( val );
+        n.valLen = static_cast<uint32_t>( val.size() );
+    }
+
+    char *allocate( size_t n ) {
+        if ( n > mArenaLeft ) {
+            const size_t block = std::max( n, blockSize );
+            mBlocks.emplace_back( new char[ block ] );
+            mArenaTop = mBlocks.back().get();
+            mArenaLeft = block;
+            mArenaBytes += block;
+        }
+        char *p = mArenaTop;
+        mArenaTop += n;
+        mArenaLeft -= n;
+        return p;
+    }
+
+    const char *copy( std::string_view s ) {
+        if ( s.empty() )
+            return "";
+        char *p = allocate( s.size() );
+        memcpy( p, s.data(), s.size() );
+        return p;
+    }
+
+    const char *intern( std::string_view s ) {
+        if ( s.empty() )
+            return "";
+        auto it = mSegments.find( s );
+        if ( it != mSegments.end() )
+            return it->data();
+        const char *p = copy( s );
+        mSegments.insert( std::string_view( p, s.size() ) );
+        return p;
+    }
+
+    std::vector<Node> mNodes;           // document order, parents always before children
+    std::vector<uint32_t> mTable;       // open addressing hash table of node indices
+    size_t mMask = 0;
+    std::vector<std::unique_ptr<char[]>> mBlocks; // arena for segments and values
+    char *mArenaTop = nullptr;
+    size_t mArenaLeft = 0;
+    size_t mArenaBytes = 0;
+    std::unordered_set<std::string_view> mSegments; // interned segments, views into the arena
+    std::vector<std::shared_ptr<const void>> mOwners; // external memory referenced by borrowed values
+};
+
+/**
+ * @brief Lazily filled cache of converted values, one lock-free list per store node keyed by type
+ * Concurrent const readers may fill it: new entries are pushed with compare-and-swap and never removed
+ * while readers can see them. Writers (resize, invalidate, reset) must not race with readers, just
+ * like writes to the config itself. Copies start empty.
+ */
+class TXmlConfigTypedCache {
+public:
+    TXmlConfigTypedCache() {}
+    TXmlConfigTypedCache( const TXmlConfigTypedCache &o ) : mEnabled( o.mEnabled ) {}
+    TXmlConfigTypedCache &operator=( const TXmlConfigTypedCache &o ) {
+        reset();
+        mEnabled = o.mEnabled;
+        return *this;
+    }
+    ~TXmlConfigTypedCache() { reset(); }
+
+    bool enabled() const { return mEnabled; }
+    void enable( bool on ) {
+        mEnabled = on;
+        if ( !on )
+            reset();
+    }
+
+    /**
+     * @brief drop every cached value
+     */
+    void reset() {
+        for ( size_t i = 0; i < mSize; i++ )
+            release( mSlots[ i ].exchange( nullptr ) );
+        mSlots.reset();
+        mSize = 0;
+    }
+
+    /**
+     * @brief drop the cached values of one node and make room for nodes up to size
+     */
+    void invalidate( uint32_t id, size_t size ) {
+        if ( !mEnabled )
+            return;
+        if ( size > mSize ) {
+            const size_t n = std::max( size, 2 * mSize );
+            std::unique_ptr<std::atomic<Entry *>[]> slots( new std::atomic<Entry *>[ n ] );
+            for ( size_t i = 0; i < n; i++ )
+                slots[ i ].store( i < mSize ? mSlots[ i ].load() : nullptr );
+            mSlots.swap( slots );
+            mSize = n;
+        }
+        if ( id < mSize )
+            release( mSlots[ id ].exchange( nullptr ) );
+    }
+
+    /**
+     * @brief the cached value of type V for a node, computed with make() on first use
+     * 
+     * @param id store index of the node
+     * @param make callable returning the converted V
+     * @return V cached value
+     */
+    template <typename V, typename F>
+    V get( uint32_t id, F make ) const {
+        if ( id >= mSize )
+            return make();
+        std::atomic<Entry *> &slot = mSlots[ id ];
+        Entry *head = slot.load( std::memory_order_acquire );
+        if ( const Value<V> *v = find<V>( head ) )
+            return v->value;
+
+        Value<V> *v = new Value<V>( make() );
+        v->type = tag<V>();
+        for ( ;; ) {
+            v->next = head;
+            if ( slot.compare_exchange_weak( head, v, std::memory_order_acq_rel, std::memory_order_acquire ) )
+                return v->value;
+            // someone else pushed meanwhile, use theirs if it is the same type
+            if ( const Value<V> *other = find<V>( head ) ) {
+                V rv = other->value;
+                delete v;
+                return rv;
+            }
+        }
+    }
+
+protected:
+    struct Entry {
+        const void *type = nullptr;
+        Entry *next = nullptr;
+        virtual ~Entry() {}
+    };
+    template <typename V>
+    struct Value : Entry {
+        Value( V v ) : value( std::move( v ) ) {}
+        V value;
+    };
+
+    template <typename V>
+    static const void *tag() {
+        static const char t = 0;
+        return &t;
+    }
+
+    template <typename V>
+    static const Value<V> *find( const Entry *e ) {
+        for ( ; e != nullptr; e = e->next )
+            if ( e->type == tag<V>() )
+                return static_cast<const Value<V> *>( e );
+        return nullptr;
+    }
+
+    static void release( Entry *e ) {
+        while ( e != nullptr ) {
+            Entry *next = e->next;
+            delete e;
+            e = next;
+        }
+    }
+
+    bool mEnabled = false;
+    mutable std::unique_ptr<std::atomic<Entry *>[]> mSlots;
+    size_t mSize = 0;
+};
+
+/**
+ * @brief Opt-in read counters per store node, plus the paths that fell back to their default value
+ * Counters are relaxed atomics so concurrent const readers can bump them. Like the typed cache,
+ * resize and clear must not race with readers. Copies start empty.
+ */
+class TXmlConfigAccessStats {
+public:
+    TXmlConfigAccessStats() {}
+    TXmlConfigAccessStats( const TXmlConfigAccessStats &o ) { enable( o.mEnabled ); }
+    TXmlConfigAccessStats &operator=( const TXmlConfigAccessStats &o ) {
+        mEnabled = o.mEnabled;
+        clear();
+        return *this;
+    }
+
+    bool enabled() const { return mEnabled; }
+    void enable( bool on ) {
+        const bool was = mEnabled;
+        mEnabled = on;
+        if ( on != was )
+            clear();
+    }
+
+    /**
+     * @brief forget every count
+     */
+    void clear() {
+        mCounters.reset();
+        mSize = 0;
+        mDefaultSlots.reset( mEnabled ? new DefaultSlot[ defaultSlots ] : nullptr );
+        std::lock_guard<std::mutex> lock( mMutex );
+        mDefaults.clear();
+    }
+
+    /**
+     * @brief make room for nodes up to size, keeping the counts so far
+     */
+    void resize( size_t size ) {
+        if ( !mEnabled || size <= mSize )
+            return;
+        const size_t n = std::max( size, 2 * mSize );
+        std::unique_ptr<Counters[]> counters( new Counters[ n ] );
+        for ( size_t i = 0; i < mSize; i++ ) {
+            counters[ i ].reads.store( mCounters[ i ].reads.load() );
+            counters[ i ].ns.store( mCounters[ i ].ns.load() );
+        }
+        mCounters.swap( counters );
+        mSize = n;
+    }
+
+    /**
+     * @brief count a read of node id that took ns nanoseconds
+     */
+    void read( uint32_t id, uint64_t ns ) const {
+        if ( id >= mSize )
+            return;
+        mCounters[ id ].reads.fetch_add( 1, std::memory_order_relaxed );
+        mCounters[ id ].ns.fetch_add( ns, std::memory_order_relaxed );
+    }
+
+    /**
+     * @brief count a read of a canonical path that DNE, so the default value was returned
+     * Paths get a slot by their hash, the first read of a path copies it and later ones are a relaxed increment.
+     * Only when the slots near the hash are all taken by other paths does the count go through a locked map.
+     *
+     * @param path canonical path
+     * @param hash TXmlConfigStore::hashKey of path
+     */
+    void defaulted( std::string_view path, uint64_t hash ) const {
+        if ( !mDefaultSlots )
+            return;
+        hash |= 1; // 0 marks a free slot
+        for ( size_t probe = 0; probe < maxProbes; probe++ ) {
+            DefaultSlot &slot = mDefaultSlots[ ( hash + probe ) & ( defaultSlots - 1 ) ];
+            uint64_t h = slot.hash.load( std::memory_order_acquire );
+            if ( h == 0 && slot.hash.compare_exchange_strong( h, hash, std::memory_order_acq_rel ) ) {
+                slot.path.store( new std::string( path ), std::memory_order_release );
+                h = hash;
+            }
+            if ( h != hash )
+                continue;
+            // a slot claimed but not yet named is taken to be ours, two paths sharing a 64 bit hash are not worth waiting for
+            const std::string *p = slot.path.load( std::memory_order_acquire );
+            if ( p == nullptr || *p == path ) {
+                slot.count.fetch_add( 1, std::memory_order_relaxed );
+                return;
+            }
+        }
+        std::lock_guard<std::mutex> lock( mMutex );
+        mDefaults[ std::string( path ) ]++;
+    }
+
+    uint64_t reads( uint32_t id ) const { return id < mSize ? mCounters[ id ].reads.load( std::memory_order_relaxed ) : 0; }
+    uint64_t nanoseconds( uint32_t id ) const { return id < mSize ? mCounters[ id ].ns.load( std::memory_order_relaxed ) : 0; }
+
+    /**
+     * @brief the paths read but missing, with their counts
+     */
+    std::map<std::string, uint64_t> defaults() const {
+        std::lock_guard<std::mutex> lock( mMutex );
+        std::map<std::string, uint64_t> all( mDefaults.begin(), mDefaults.end() );
+        for ( size_t i = 0; mDefaultSlots && i < defaultSlots; i++ ) {
+            const DefaultSlot &slot = mDefaultSlots[ i ];
+            const uint64_t n = slot.count.load( std::memory_order_relaxed );
+            if ( const std::string *p = slot.path.load( std::memory_order_acquire ) )
+                if ( n > 0 )
+                    all[ *p ] += n;
+        }
+        return all;
+    }
+
+protected:
+    struct Counters {
+        std::atomic<uint64_t> reads{ 0 };
+        std::atomic<uint64_t> ns{ 0 };
+    };
+
+    struct DefaultSlot {
+        ~DefaultSlot() { delete path.load(); }
+        std::atomic<uint64_t> hash{ 0 };
+        std::atomic<const std::string *> path{ nullptr }; // set once by the reader that claimed the slot
+        std::atomic<uint64_t> count{ 0 };
+    };
+    static constexpr size_t defaultSlots = 1024; // distinct missing paths counted without a lock
+    static constexpr size_t maxProbes = 16;
+
+    bool mEnabled = false;
+    std::unique_ptr<Counters[]> mCounters;
+    size_t mSize = 0;
+    std::unique_ptr<DefaultSlot[]> mDefaultSlots; // open addressing by path hash, allocated while enabled
+    mutable std::mutex mMutex; // guards mDefaults
+    mutable std::unordered_map<std::string, uint64_t> mDefaults; // paths that found no free slot
+};
+
+/**
+ * @brief A canonical path with its hash computed at compile time, see TXML_PATH
+ * Lookups with it skip canonizing and hashing, only probing the store remains.
+ * The path is held as a view, so it must outlive the TXmlConfigPath (string literals do).
+ */
+class TXmlConfigPath {
+public:
+    constexpr TXmlConfigPath( std::string_view path, uint64_t hash ) : mPath( path ), mHash( hash ) {}
+
+    /**
+     * @brief hash of a canonical path, not a constant expression (compile error in TXML_PATH) if path is not canonical
+     */
+    static constexpr uint64_t hashOf( std::string_view path ) {
+        for ( size_t i = 0; i < path.size(); i++ ) {
+            const char c = path[ i ];
+            if ( c == ' ' || ( c >= '\t' && c <= '\r' ) )
+                throw std::invalid_argument( "TXML_PATH: whitespace in path" );
+            if ( c == '[' && i + 2 < path.size() && path[ i + 1 ] == '0' && path[ i + 2 ] == ']' )
+                throw std::invalid_argument( "TXML_PATH: [0] in path" );
+        }
+        return TXmlConfigStore::hashKey( path );
+    }
+
+    constexpr std::string_view path() const { return mPath; }
+    constexpr uint64_t hash() const { return mHash; }
+
+protected:
+    std::string_view mPath;
+    uint64_t mHash;
+};
+
+// a TXmlConfigPath for a canonical string literal, hashed at compile time
+#define TXML_PATH( p ) TXmlConfigPath( p, std::integral_constant<uint64_t, TXmlConfigPath::hashOf( p )>::value )
 
 // Class provides an interface for reading configuration from an XML file
 class TXmlConfig {
+    friend class TXmlConfigValidator; // runs over the flattened store and fills the typed cache
+    friend class TXmlConfigTable; // TXmlConfigTree.h, fills columns in one scan of the flattened store
+    template <typename T>
+    friend class TXmlConfigFactory; // books objects in one walk of the flattened store
+    friend class TXmlConfigLive; // publishes a config marked as failed when the first load fails
+
+protected:
+
+    static const std::string valDNE; // used for nodes that DNE
+    static const std::string pathDelim; // separate node levels
+    static const std::string attrDelim; // separate attributes on nodes
+    static const std::string binaryExt; // appended to the source file name for kCached snapshots
+
+    bool mErrorParsing = false;
+    // read only store of the config, read with get<> functions
+    TXmlConfigStore mNodes;
+    // renewed by every load() and set(), lets Key<T> handles know when to refresh
+    // drawn from one process wide counter, so a config assigned from another never reuses a generation
+    uint64_t mGeneration = nextGeneration();
+    // opt-in memo of converted numeric values and vectors, see enableTypedCache
+    TXmlConfigTypedCache mTypedCache;
+    // opt-in read counters, see enableAccessStats
+    TXmlConfigAccessStats mAccessStats;
+    // for overlays: the shared config read for every path this one does not hold, see TXmlConfig( parent )
+    std::shared_ptr<const TXmlConfig> mParent;
+    // for overlays and kLazy: the merged trees below the paths structural queries asked for, see structure()
+    struct FlatCache {
+        std::mutex mutex; // guards stores
+        std::unordered_map<std::string, std::shared_ptr<const TXmlConfigStore>> stores; // by canonical path, "" for the full tree
+    };
+    // created on the first structural query and dropped by set(), copies share it until then
+    mutable std::shared_ptr<FlatCache> mFlat;
+
+    // kLazy: one top level node of the document, mapped into its own config on first use
+    struct LazySection {
+        std::string key;       // canonical path of the node, e.g. "Sector[2]"
+        uint32_t index = 0;    // repeated node index
+        std::string_view text; // the element in the document, from "<" to the end of its closing tag
+        std::once_flag once;
+        std::unique_ptr<TXmlConfig> cfg;
+    };
+    struct LazyDocument {
+        std::shared_ptr<const void> owner; // keeps the document text alive
+        std::vector<std::unique_ptr<LazySection>> sections;
+        std::unordered_map<std::string_view, size_t> byKey;
+        size_t rootNodes = 0; // store size after the skim, larger once set() wrote to the config
+    };
+    // kLazy: the skimmed document, shared by copies since sections never change once mapped
+    std::shared_ptr<LazyDocument> mLazy;
+
+    /**
+     * @brief true for the arithmetic types handled by std::from_chars / std::to_chars
+     * bool and the character types keep their dedicated / stream based conversions
+     */
+    template <typename T>
+    static constexpr bool isNumeric = std::is_arithmetic<T>::value &&
+                                      !std::is_same<T, bool>::value &&
+                                      !std::is_same<T, char>::value &&
+                                      !std::is_same<T, signed char>::value &&
+                                      !std::is_same<T, unsigned char>::value &&
+                                      !std::is_same<T, wchar_t>::value &&
+                                      !std::is_same<T, char16_t>::value &&
+                                      !std::is_same<T, char32_t>::value;
+
+    /**
+     * @brief per-thread stream used as fallback for types without a from_chars / to_chars path
+     * Each thread owns its instance so concurrent const readers never share mutable state
+     * @return std::stringstream& emptied stream for the calling thread
+     */
+    static std::stringstream &threadStream() {
+        thread_local std::stringstream ss = [](){
+            std::stringstream s;
+            s.imbue( std::locale::classic() );
+            return s;
+        }();
+        ss.str("");
+        ss.clear();
+        return ss;
+    }
+
+    /**
+     * @brief locale independent parse of an arithmetic value
+     * Mirrors stream extraction: leading whitespace and a leading '+' are skipped
+     * @param s input string
+     * @param rv output value, untouched if parsing fails
+     * @param whole true: fail on anything but whitespace after the number, as stream extraction would not
+     * @return true on success
+     */
+    template <typename T>
+    static bool fromChars( std::string_view s, T &rv, bool whole = false ) {
+        const char *first = s.data();
+        const char *last = first + s.size();
+        while ( first != last && std::isspace( static_cast<unsigned char>(*first) ) )
+            ++first;
+        if ( first != last && *first == '+' ) {
+            ++first;
+            if ( first != last && *first == '-' )
+                return false;
+        }
+        const std::from_chars_result res = std::from_chars( first, last, rv );
+        if ( res.ec != std::errc() )
+            return false;
+        first = res.ptr;
+        while ( whole && first != last && std::isspace( static_cast<unsigned char>(*first) ) )
+            ++first;
+        return !whole || first == last;
+    }
+
+    /**
+     * @brief locale independent formatting of an arithmetic value, appended to out
+     * floating point values are written in the shortest form that reads back exactly,
+     * or with TXmlConfig::precision significant digits when that is set
+     * @param out string to append to
+     * @param v value to format
+     */
+    template <typename T>
+    static void appendChars( std::string &out, T v ) {
+        char buf[64];
+        std::to_chars_result res;
+        if constexpr ( std::is_same<T, bool>::value )
+            res = std::to_chars( buf, buf + sizeof(buf), static_cast<int>( v ) );
+        else if constexpr ( std::is_floating_point<T>::value )
+            res = TXmlConfig::precision > 0 ? std::to_chars( buf, buf + sizeof(buf), v, std::chars_format::general, TXmlConfig::precision )
+                                            : std::to_chars( buf, buf + sizeof(buf), v );
+        else
+            res = std::to_chars( buf, buf + sizeof(buf), v );
+        out.append( buf, res.ptr );
+    }
+
+    /**
+     * @brief locale independent formatting of an arithmetic value, see appendChars
+     * @param v value to format
+     * @return std::string representation of v
+     */
+    template <typename T>
+    static std::string toChars( T v ) {
+        std::string out;
+        appendChars( out, v );
+        return out;
+    }
+
+    /**
+     * @brief store index of the node holding a value at a canonical path
+     * 
+     * @param path canonical path to lookup
+     * @return uint32_t node index, TXmlConfigStore::npos if the path DNE
+     */
+    uint32_t findValue( std::string_view path ) const {
+        const uint32_t id = mNodes.findId( path );
+        if ( id == TXmlConfigStore::npos || mNodes.node( id ).val == nullptr )
+            return TXmlConfigStore::npos;
+        return id;
+    }
+
+    /**
+     * @brief the config holding a value at path: this one, or for overlays the nearest parent
+     * 
+     * @param path path to lookup, canonized once if needed
+     * @param id set to the node index in the returned config, TXmlConfigStore::npos if the path DNE
+     * @return const TXmlConfig* config to read node id from
+     */
+    const TXmlConfig *locate( std::string_view path, uint32_t &id ) const {
+        std::string p;
+        if ( !isCanonical( path ) ) {
+            p.assign( path.data(), path.size() );
+            TXmlConfig::canonize( p );
+            path = p;
+        }
+        for ( const TXmlConfig *c = this; c != nullptr; c = c->mParent.get() ) {
+            id = c->findValue( path );
+            if ( id != TXmlConfigStore::npos )
+                return c;
+            if ( const TXmlConfig *sec = c->section( path ) ) {
+                id = sec->findValue( path );
+                if ( id != TXmlConfigStore::npos )
+                    return sec;
+            }
+        }
+        id = TXmlConfigStore::npos;
+        return this;
+    }
+
+    /**
+     * @brief kLazy: the config of the section holding canonical path, mapped on first use
+     * 
+     * @return const TXmlConfig* section config, nullptr if not lazy or no section matches
+     */
+    const TXmlConfig *section( std::string_view path ) const {
+        if ( !mLazy )
+            return nullptr;
+        auto it = mLazy->byKey.find( path.substr( 0, path.find_first_of( ".:" ) ) );
+        if ( it == mLazy->byKey.end() )
+            return nullptr;
+        return &section( *mLazy->sections[ it->second ] );
+    }
+
+    const TXmlConfig &section( LazySection &sec ) const {
+        std::call_once( sec.once, [&]() {
+            auto cfg = std::make_unique<TXmlConfig>();
+            std::string doc;
+            doc.reserve( sec.text.size() + 32 );
+            doc.append( "<config>" ).append( sec.text.data(), sec.text.size() ).append( "</config>" );
+            if ( !cfg->mapStream( doc, false, sec.index ) ) {
+                cfg->mNodes.clear(); // the skim only checked the nesting, an empty section beats a partial one
+                cfg->mErrorParsing = true;
+            }
+            cfg->mNodes.setValueRef( 0, std::string_view() ); // the wrapper root is not ours
+            if ( mTypedCache.enabled() )
+                cfg->enableTypedCache();
+            if ( mAccessStats.enabled() )
+                cfg->enableAccessStats(); // reads inside the section are counted by it, see accessStats
+            sec.cfg = std::move( cfg );
+        } );
+        return *sec.cfg;
+    }
+
+    /**
+     * @brief kLazy: record the top level nodes of doc without mapping them, map only the root node itself
+     * 
+     * @param doc complete xml document
+     * @param owner keeps doc alive as long as the sections may need it
+     * @return true on success, false if the document is malformed
+     */
+    bool skim( std::string_view doc, std::shared_ptr<const void> owner ) {
+        const char *p = doc.data(), *end = doc.data() + doc.size();
+        auto startsWith = [&]( const char *q, const char *prefix ) {
+            const size_t n = strlen( prefix );
+            return static_cast<size_t>( end - q ) >= n && 0 == memcmp( q, prefix, n );
+        };
+        auto skipPast = [&]( const char *q, const char *marker ) -> const char * {
+            const char *m = std::search( q, end, marker, marker + strlen( marker ) );
+            return m == end ? nullptr : m + strlen( marker );
+        };
+        // markup that is not an element: returns the position after it, q if q is an element, nullptr if unterminated
+        auto skipMarkup = [&]( const char *q ) -> const char * {
+            if ( startsWith( q, "<!--" ) ) return skipPast( q, "-->" );
+            if ( startsWith( q, "<![CDATA[" ) ) return skipPast( q, "]]>" );
+            if ( startsWith( q, "<?" ) ) return skipPast( q, "?>" );
+            if ( startsWith( q, "<!" ) ) return skipPast( q, ">" );
+            return q;
+        };
+        // end of the tag starting at q, quoted attribute values may hold '>'
+        auto tagEnd = [&]( const char *q ) -> const char * {
+            for ( ++q; q != end; ++q ) {
+                if ( *q == '"' || *q == '\'' ) {
+                    q = std::find( q + 1, end, *q );
+                    if ( q == end ) return nullptr;
+                } else if ( *q == '>' ) {
+                    return q + 1;
+                }
+            }
+            return nullptr;
+        };
+        auto nameAt = [&]( const char *q ) {
+            const char *e = q;
+            while ( e != end && !std::isspace( static_cast<unsigned char>( *e ) ) && *e != '>' && *e != '/' ) ++e;
+            return std::string_view( q, e - q );
+        };
+
+        // prolog, then the root start tag
+        for ( ;; ) {
+            p = std::find( p, end, '<' );
+            if ( p == end ) return false;
+            const char *next = skipMarkup( p );
+            if ( next == nullptr ) return false;
+            if ( next == p ) break;
+            p = next;
+        }
+        const char *rootEnd = tagEnd( p );
+        if ( rootEnd == nullptr ) return false;
+        const std::string_view rootName = nameAt( p + 1 );
+
+        // the root node alone: its attributes and leading text (or CDATA)
+        const char *firstChild = std::find( rootEnd, end, '<' );
+        if ( rootEnd[ -2 ] != '/' && startsWith( firstChild, "<![CDATA[" ) ) {
+            firstChild = skipPast( firstChild, "]]>" );
+            if ( firstChild == nullptr ) return false;
+        }
+        std::string root( p, rootEnd - p );
+        if ( rootEnd[ -2 ] != '/' )
+            root.append( rootEnd, firstChild - rootEnd ).append( "</" ).append( rootName.data(), rootName.size() ).append( ">" );
+        if ( !mapStream( root ) )
+            return false;
+
+        auto lazy = std::make_shared<LazyDocument>();
+        lazy->owner = owner;
+        if ( rootEnd[ -2 ] != '/' ) {
+            std::unordered_map<std::string_view, uint32_t> siblings;
+            for ( p = firstChild;; ) {
+                p = std::find( p, end, '<' );
+                if ( p == end ) return false;
+                if ( startsWith( p, "</" ) ) break; // end of the root node
+                const char *next = skipMarkup( p );
+                if ( next == nullptr ) return false;
+                if ( next != p ) {
+                    p = next;
+                    continue;
+                }
+
+                // a top level element, find its end by counting nesting
+                const char *start = p;
+                for ( int depth = 0;; ) {
+                    p = std::find( p, end, '<' );
+                    if ( p == end ) return false;
+                    next = skipMarkup( p );
+                    if ( next == nullptr ) return false;
+                    if ( next != p ) {
+                        p = next;
+                        continue;
+                    }
+                    const char *e = tagEnd( p );
+                    if ( e == nullptr ) return false;
+                    const bool closing = p[1] == '/', selfClosing = e[ -2 ] == '/';
+                    p = e;
+                    depth += closing ? -1 : ( selfClosing ? 0 : 1 );
+                    if ( depth == 0 )
+                        break;
+                }
+
+                auto sec = std::make_unique<LazySection>();
+                const std::string_view name = nameAt( start + 1 );
+                sec->index = siblings.try_emplace( name, 0 ).first->second++;
+                sec->key.assign( name.data(), name.size() );
+                if ( sec->index )
+                    sec->key += "[" + std::to_string( sec->index ) + "]";
+                sec->text = std::string_view( start, p - start );
+                lazy->sections.push_back( std::move( sec ) );
+            }
+        }
+        for ( size_t i = 0; i < lazy->sections.size(); i++ )
+            lazy->byKey.emplace( lazy->sections[ i ]->key, i );
+        lazy->rootNodes = mNodes.size();
+        mLazy = lazy;
+        return true;
+    }
+
+    /**
+     * @brief locate for a path hashed at compile time, no canonizing or hashing
+     */
+    const TXmlConfig *locate( const TXmlConfigPath &path, uint32_t &id ) const {
+        for ( const TXmlConfig *c = this; c != nullptr; c = c->mParent.get() ) {
+            id = c->mNodes.findId( path.path(), path.hash() );
+            if ( id != TXmlConfigStore::npos && c->mNodes.node( id ).val != nullptr )
+                return c;
+            if ( const TXmlConfig *sec = c->section( path.path() ) ) {
+                id = sec->mNodes.findId( path.path(), path.hash() );
+                if ( id != TXmlConfigStore::npos && sec->mNodes.node( id ).val != nullptr )
+                    return sec;
+            }
+        }
+        id = TXmlConfigStore::npos;
+        return this;
+    }
+
+    /**
+     * @brief locate path and return f( config, id ), recording the read when access stats are enabled
+     * Reads are counted by the config holding the value, defaults by this one
+     */
+    template <typename P, typename F>
+    auto read( const P &path, F f ) const {
+        uint32_t id;
+        const TXmlConfig *c = locate( path, id );
+        if ( !mAccessStats.enabled() && !c->mAccessStats.enabled() )
+            return f( c, id );
+        const auto start = std::chrono::steady_clock::now();
+        auto result = f( c, id );
+        if ( id != TXmlConfigStore::npos ) {
+            c->mAccessStats.read( id, std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count() );
+        } else if ( mAccessStats.enabled() ) {
+            if constexpr ( std::is_same<P, TXmlConfigPath>::value ) {
+                mAccessStats.defaulted( path.path(), path.hash() );
+            } else if ( isCanonical( path ) ) {
+                mAccessStats.defaulted( path, TXmlConfigStore::hashKey( path ) );
+            } else {
+                std::string p( path );
+                TXmlConfig::canonize( p );
+                mAccessStats.defaulted( p, TXmlConfigStore::hashKey( p ) );
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief the tree of this config at and below a canonical path, for structural queries (child lists, dump, xml)
+     * Overlays have the parent with the overrides merged in, kLazy configs their sections mapped and merged.
+     * Only the part below path is merged, and only when this config wrote something there, so queries on
+     * an overlay cost the size of the subtree asked for instead of the whole parent.
+     * Node ids are ids in the returned store, which stays valid until the next set().
+     *
+     * @param path canonical path, "" for the full tree
+     */
+    const TXmlConfigStore &structure( std::string_view path = "" ) const {
+        return *structurePtr( path );
+    }
+
+    /**
+     * @brief structure() sharing ownership of the store, so a merged one outlives the set() that drops it
+     * The store of a config is held through the overlay or kLazy config that owns it, and the own store of
+     * this config (which set() changes in place) is not owned at all: it stays valid until the next load().
+     *
+     * @param path canonical path, "" for the full tree
+     */
+    std::shared_ptr<const TXmlConfigStore> structurePtr( std::string_view path = "" ) const {
+        if ( !mParent && !mLazy )
+            return std::shared_ptr<const TXmlConfigStore>( std::shared_ptr<const TXmlConfigStore>(), &mNodes );
+        if ( !path.empty() && mNodes.findId( path ) == TXmlConfigStore::npos ) {
+            // nothing written at or below path, so the parent or the section has the whole subtree
+            if ( mParent ) {
+                std::shared_ptr<const TXmlConfigStore> base = mParent->structurePtr( path );
+                // the own store of the parent, keep the parent alive instead
+                return base.use_count() > 0 ? base : std::shared_ptr<const TXmlConfigStore>( mParent, base.get() );
+            }
+            const TXmlConfig *sec = section( path );
+            if ( sec )
+                return std::shared_ptr<const TXmlConfigStore>( mLazy, &sec->mNodes );
+            return std::shared_ptr<const TXmlConfigStore>( std::shared_ptr<const TXmlConfigStore>(), &mNodes );
+        }
+
+        std::shared_ptr<FlatCache> cache = std::atomic_load( &mFlat );
+        if ( !cache ) {
+            // concurrent readers may race to create it, the first one wins
+            std::shared_ptr<FlatCache> expected;
+            cache = std::make_shared<FlatCache>();
+            if ( !std::atomic_compare_exchange_strong( &mFlat, &expected, cache ) )
+                cache = expected;
+        }
+        std::lock_guard<std::mutex> lock( cache->mutex );
+        std::shared_ptr<const TXmlConfigStore> &flat = cache->stores[ std::string( path ) ];
+        if ( !flat ) {
+            auto merged = std::make_shared<TXmlConfigStore>();
+            if ( path.empty() ) {
+                if ( mParent )
+                    *merged = mParent->structure();
+                if ( mLazy ) {
+                    // every section is needed for the full tree, between the root node and the set() entries
+                    // to keep the document order
+                    merged->merge( mNodes, 0, mLazy->rootNodes );
+                    for ( auto &sec : mLazy->sections )
+                        merged->merge( section( *sec ).mNodes );
+                    merged->merge( mNodes, mLazy->rootNodes );
+                } else {
+                    merged->merge( mNodes );
+                }
+            } else {
+                if ( mParent ) {
+                    const TXmlConfigStore &base = mParent->structure( path );
+                    merged->mergeSubtree( base, base.findId( path ) );
+                } else if ( const TXmlConfig *sec = section( path ) ) {
+                    merged->mergeSubtree( sec->mNodes, sec->mNodes.findId( path ) );
+                }
+                merged->mergeSubtree( mNodes, mNodes.findId( path ) );
+            }
+            flat = merged;
+        }
+        return flat;
+    }
+
+    /**
+     * @brief whether canonize would leave path unchanged (no whitespace, no "[0]")
+     */
+    static bool isCanonical( std::string_view path ) {
+        for ( char c : path )
+            if ( std::isspace( static_cast<unsigned char>( c ) ) )
+                return false;
+        return path.find( "[0]" ) == std::string_view::npos;
+    }
+
+    /**
+     * @brief the structure() for any path and the index of its node in it, including implicit nodes
+     * The path is copied and canonized only when it is not canonical already
+     * 
+     * @param path path to lookup
+     * @param id set to the node index, TXmlConfigStore::npos if the path DNE
+     * @return const TXmlConfigStore& the store id refers to
+     */
+    const TXmlConfigStore &resolveNode( std::string_view path, uint32_t &id ) const {
+        return *resolveNodePtr( path, id );
+    }
+
+    /**
+     * @brief resolveNode sharing ownership of the store, see structurePtr
+     */
+    std::shared_ptr<const TXmlConfigStore> resolveNodePtr( std::string_view path, uint32_t &id ) const {
+        std::string p;
+        if ( !isCanonical( path ) ) {
+            p.assign( path.data(), path.size() );
+            TXmlConfig::canonize( p );
+            path = p;
+        }
+        std::shared_ptr<const TXmlConfigStore> nodes = structurePtr( path );
+        id = nodes->findId( path );
+        return nodes;
+    }
+
+    /**
+     * @brief write a string value to any path and record the write
+     * The path is copied and canonized only when it is not canonical already
+     */
+    void write( std::string_view path, std::string_view val ) {
+        if ( isCanonical( path ) ) {
+            touched( mNodes.set( path, val ) );
+        } else {
+            std::string p( path );
+            TXmlConfig::canonize( p );
+            touched( mNodes.set( p, val ) );
+        }
+    }
+
+    /**
+     * @brief true for the value types get / set / getVector handle directly from a string_view path
+     * other types are routed through the std::string overloads, so specializations of those keep working
+     */
+    template <typename T>
+    static constexpr bool isPlain = std::is_arithmetic<T>::value ||
+                                    std::is_same<T, std::string>::value ||
+                                    std::is_same<T, std::string_view>::value;
+
+    /**
+     * @brief convert the value of node id, or return dv if id is npos
+     * numeric types parse straight from the stored value and use the typed cache when enabled
+     */
+    template <typename T>
+    T valueOf( uint32_t id, const T &dv ) const {
+        if ( id == TXmlConfigStore::npos )
+            return dv;
+        const std::string_view val = TXmlConfigStore::value( mNodes.node( id ) );
+        if constexpr ( std::is_same<T, std::string_view>::value ) {
+            return val;
+        } else if constexpr ( std::is_arithmetic<T>::value ) {
+            if ( mTypedCache.enabled() )
+                return mTypedCache.get<T>( id, [&]() { return convertElement<T>( val ); } );
+            return convertElement<T>( val );
+        } else {
+            return convert<T>( std::string( val ) );
+        }
+    }
+
+    /**
+     * @brief the list of node id converted to a vector, or dv if id is npos
+     */
+    template <typename T>
+    std::vector<T> vectorOf( uint32_t id, const std::vector<T> &dv ) const {
+        if ( id == TXmlConfigStore::npos )
+            return dv;
+        auto make = [&]() { return parseVector<T>( TXmlConfigStore::value( mNodes.node( id ) ) ); };
+        if constexpr ( std::is_arithmetic<T>::value ) {
+            if ( mTypedCache.enabled() )
+                return mTypedCache.get<std::vector<T>>( id, make );
+        }
+        return make();
+    }
+
+    /**
+     * @brief record a write to node id: caches and handles see the new value
+     */
+    void touched( uint32_t id ) {
+        mTypedCache.invalidate( id, mNodes.size() );
+        mAccessStats.resize( mNodes.size() );
+        mFlat.reset();
+        mGeneration = nextGeneration();
+    }
+
+    /**
+     * @brief a generation no config in the process has used before
+     */
+    static uint64_t nextGeneration() {
+        static std::atomic<uint64_t> generations( 0 );
+        return generations.fetch_add( 1, std::memory_order_relaxed ) + 1;
+    }
+
+    /**
+     * @brief call f( element ) for each element of a comma separated list, without copying
+     * Same elements as removing all whitespace and splitting with getline: elements are trimmed,
+     * empty elements are kept except a trailing one. Commas are found with memchr, which is
+     * vectorized by all mainstream C libraries, so long lists are scanned many bytes at a time.
+     * 
+     * @param val the list
+     * @param f callable taking a std::string_view
+     */
+    template <typename F>
+    static void splitList( std::string_view val, F f ) {
+        // the "C" locale std::isspace set, inlined
+        auto isSpace = []( char c ) { return c == ' ' || ( c >= '\t' && c <= '\r' ); };
+        std::string stripped; // only used for elements with inner whitespace
+        const char *p = val.data();
+        const char *end = p + val.size();
+        for ( ;; ) {
+            const char *comma = static_cast<const char *>( memchr( p, ',', end - p ) );
+            const char *first = p;
+            const char *last = comma ? comma : end;
+            while ( first != last && isSpace( *first ) ) ++first;
+            while ( last != first && isSpace( last[-1] ) ) --last;
+            std::string_view elem( first, last - first );
+            if ( comma == nullptr && elem.empty() )
+                return;
+            if ( std::find_if( elem.begin(), elem.end(), isSpace ) != elem.end() ) {
+                stripped.assign( elem.begin(), elem.end() );
+                stripped.erase( std::remove_if( stripped.begin(), stripped.end(), isSpace ), stripped.end() );
+                elem = stripped;
+            }
+            f( elem );
+            if ( comma == nullptr )
+                return;
+            p = comma + 1;
+        }
+    }
+
+    /**
+     * @brief convert one list element, numeric types straight from the view
+     */
+    template <typename T>
+    T convertElement( std::string_view elem ) const {
+        if constexpr ( TXmlConfig::isNumeric<T> ) {
+            T rv{};
+            TXmlConfig::fromChars( elem, rv );
+            return rv;
+        } else {
+            return convert<T>( std::string( elem ) );
+        }
+    }
+
+    /**
+     * @brief split a comma separated list and convert each element
+     */
+    template <typename T>
+    std::vector<T> parseVector( std::string_view val ) const {
+        std::vector<T> result;
+        splitList( val, [&]( std::string_view elem ) { result.push_back( convertElement<T>( elem ) ); } );
+        return result;
+    }
+
+    /**
+     * @brief find the value stored at a path already in canonical form
+     * 
+     * @param path canonical path to lookup
+     * @param value set to the stored value if found
+     * @return true if the path exists
+     */
+    bool find( std::string_view path, std::string_view &value ) const {
+        for ( const TXmlConfig *c = this; c != nullptr; c = c->mParent.get() ) {
+            const TXmlConfigStore::Node *n = c->mNodes.lookup( path );
+            if ( n == nullptr ) {
+                if ( const TXmlConfig *sec = c->section( path ) )
+                    n = sec->mNodes.lookup( path );
+            }
+            if ( n != nullptr ) {
+                value = TXmlConfigStore::value( *n );
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief scratch space reused by every mapFile call of one document, so mapping allocates
+     * only for the store itself (and for the sibling counters of the first node at each level)
+     */
+    struct MapScratch {
+        std::string seg;
+        std::vector<std::unordered_map<std::string_view, uint32_t>> siblings; // one per level, cleared per node
+    };
+
+    /**
+     * @brief Reads an xml document and writes it into map
+     * 
+     * @param xml xml document to map
+     * @param node starting node - allows recursive mapping
+     * @param level the integer index of the level of current parsing
+     * @param scratch buffers shared by the whole pass
+     * @param parent the store index of the parent node
+     * @param index number of earlier siblings with the same name, used as array index
+     */
+    void mapFile(TXMLEngine &xml, XMLNodePointer_t node, Int_t level, MapScratch &scratch, uint32_t parent = 0, uint32_t index = 0) {
+        using namespace std;
+
+        // names and values are read in place, the store copies them into its arena
+        const string_view node_name = xml.GetNodeName(node);
+        const string_view node_content = xml.GetNodeContent(node) != nullptr ? string_view( xml.GetNodeContent(node) ) : string_view( TXmlConfig::valDNE );
+
+        // the segment this node adds to the path, with the path delimeter above top level
+        // we skip the root node to maintain consistency with original XmlConfig
+        uint32_t id = 0;
+        if ( level > 1 ) {
+            string &seg = scratch.seg;
+            seg.assign( level > 2 ? TXmlConfig::pathDelim : string() );
+            seg.append( node_name.data(), node_name.size() );
+            // be careful about repeated nodes, the index becomes "[index]" in the path
+            id = mNodes.insert( parent, seg, index, node_content );
+        } else {
+            mNodes.setValue( 0, node_content );
+        }
+
+        // loop through attributes of this node
+        XMLAttrPointer_t attr = xml.GetFirstAttr(node);
+        while (attr != 0) {
+
+            // get the attribute name and value if exists
+            const char *attr_val = xml.GetAttrValue(attr);
+
+            // save attributes with the attribute delim ":" 
+            scratch.seg.assign( TXmlConfig::attrDelim );
+            scratch.seg.append( xml.GetAttrName(attr) );
+            mNodes.insert( id, scratch.seg, 0, attr_val != nullptr ? string_view( attr_val ) : string_view( TXmlConfig::valDNE ) );
+            attr = xml.GetNextAttr(attr);
+        }
+
+        // recursively get child nodes
+        // repeated siblings are counted per name as we go, keeping the mapping linear in document size
+        if ( scratch.siblings.size() < static_cast<size_t>( level ) )
+            scratch.siblings.resize( level );
+        XMLNodePointer_t child = xml.GetChild(node);
+        if ( child != 0 )
+            scratch.siblings[ level - 1 ].clear(); // keeps its buckets for the next node at this level
+        while (child != 0) {
+            const uint32_t childIndex = scratch.siblings[ level - 1 ].try_emplace( xml.GetNodeName(child), 0 ).first->second++;
+            mapFile(xml, child, level + 1, scratch, id, childIndex);
+            child = xml.GetNext(child);
+        }
+    } // mapFile
+
+    /**
+     * @brief Decode the predefined xml entities and character references
+     * 
+     * @param in raw text from the document
+     * @param buf scratch buffer, used only if in contains an entity
+     * @return std::string_view decoded text, either in itself or a view of buf
+     */
+    static std::string_view unescape( std::string_view in, std::string &buf ) {
+        size_t amp = in.find( '&' );
+        if ( amp == std::string_view::npos )
+            return in;
+
+        buf.assign( in.data(), amp );
+        while ( amp < in.size() ) {
+            const size_t semi = in.find( ';', amp );
+            if ( in[ amp ] != '&' || semi == std::string_view::npos ) {
+                buf += in[ amp++ ];
+                continue;
+            }
+            const std::string_view ent = in.substr( amp + 1, semi - amp - 1 );
+            uint32_t cp = 0;
+            if ( ent == "lt" ) cp = '<';
+            else if ( ent == "gt" ) cp = '>';
+            else if ( ent == "amp" ) cp = '&';
+            else if ( ent == "quot" ) cp = '"';
+            else if ( ent == "apos" ) cp = '\'';
+            else if ( ent.size() > 1 && ent[0] == '#' ) {
+                const bool hex = ( ent[1] == 'x' || ent[1] == 'X' );
+                const char *first = ent.data() + ( hex ? 2 : 1 );
+                const char *last = ent.data() + ent.size();
+                if ( std::from_chars( first, last, cp, hex ? 16 : 10 ).ptr != last || first == last )
+                    cp = 0;
+            }
+
+            if ( cp == 0 ) { // unknown entity, keep it verbatim
+                buf += in[ amp++ ];
+                continue;
+            }
+            // utf-8 encode the code point
+            if ( cp < 0x80 ) {
+                buf += static_cast<char>( cp );
+            } else if ( cp < 0x800 ) {
+                buf += static_cast<char>( 0xC0 | ( cp >> 6 ) );
+                buf += static_cast<char>( 0x80 | ( cp & 0x3F ) );
+            } else if ( cp < 0x10000 ) {
+                buf += static_cast<char>( 0xE0 | ( cp >> 12 ) );
+                buf += static_cast<char>( 0x80 | ( ( cp >> 6 ) & 0x3F ) );
+                buf += static_cast<char>( 0x80 | ( cp & 0x3F ) );
+            } else {
+                buf += static_cast<char>( 0xF0 | ( cp >> 18 ) );
+                buf += static_cast<char>( 0x80 | ( ( cp >> 12 ) & 0x3F ) );
+                buf += static_cast<char>( 0x80 | ( ( cp >> 6 ) & 0x3F ) );
+                buf += static_cast<char>( 0x80 | ( cp & 0x3F ) );
+            }
+            amp = semi + 1;
+        }
+        return buf;
+    }
+
+    /**
+     * @brief Maps an xml document into the store in a single pass, without building a DOM
+     * Follows the same rules as mapFile: the root node maps to the empty path, repeated siblings
+     * get array indices and the content of a node is its leading text, if any.
+     * Nesting is tracked on an explicit stack, so deep documents do not recurse.
+     * 
+     * @param doc complete xml document
+     * @param borrow true: values without entities are stored as views into doc, which must outlive the store
+     * @param rootChildIndex index of the first child of the root node, used to map a kLazy section on its own
+     * @return true on success, false if the document is malformed
+     */
+    bool mapStream( std::string_view doc, bool borrow = false, uint32_t rootChildIndex = 0 ) {
+        using namespace std;
+        struct Frame {
+            uint32_t id;
+            string_view name;
+            bool hasValue;
+            unordered_map<string_view, size_t> siblings;
+        };
+        vector<Frame> stack;
+        string seg;     // reused for building segments
+        string decoded; // reused for entity decoding
+
+        const char *p = doc.data();
+        const char *end = p + doc.size();
+
+        auto isSpace = []( char c ) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; };
+        auto skipSpace = [&]() { while ( p != end && isSpace( *p ) ) ++p; };
+        auto startsWith = [&]( string_view token ) { return static_cast<size_t>( end - p ) >= token.size() && 0 == memcmp( p, token.data(), token.size() ); };
+        auto skipPast = [&]( string_view token ) {
+            const char *q = std::search( p, end, token.begin(), token.end() );
+            p = ( q == end ) ? end : q + token.size();
+            return q != end;
+        };
+        auto readName = [&]() {
+            const char *start = p;
+            while ( p != end && !isSpace( *p ) && *p != '>' && *p != '/' && *p != '=' ) ++p;
+            return string_view( start, p - start );
+        };
+        // only decoded text needs a copy when borrowing, everything else points into doc (or at valDNE)
+        auto storeValue = [&]( uint32_t id, string_view val ) {
+            if ( borrow && val.data() != decoded.data() )
+                mNodes.setValueRef( id, val );
+            else
+                mNodes.setValue( id, val );
+        };
+        // the first child (text, element or comment) of a node decides its content
+        auto setContent = [&]( string_view content ) {
+            if ( stack.empty() || stack.back().hasValue ) return;
+            storeValue( stack.back().id, content );
+            stack.back().hasValue = true;
+        };
+
+        while ( p != end ) {
+            // text between tags, leading whitespace is not content
+            skipSpace();
+            const char *lt = std::find( p, end, '<' );
+            if ( lt != p )
+                setContent( unescape( string_view( p, lt - p ), decoded ) );
+            p = lt;
+            if ( p == end )
+                break;
+
+            if ( startsWith( "<?" ) ) {
+                if ( !skipPast( "?>" ) ) return false;
+            } else if ( startsWith( "<!--" ) ) {
+                setContent( TXmlConfig::valDNE );
+                if ( !skipPast( "-->" ) ) return false;
+            } else if ( startsWith( "<![CDATA[" ) ) {
+                p += 9;
+                const char *content = p;
+                if ( !skipPast( "]]>" ) ) return false;
+                setContent( string_view( content, p - 3 - content ) );
+            } else if ( startsWith( "<!" ) ) { // DOCTYPE and friends
+                if ( !skipPast( ">" ) ) return false;
+            } else if ( startsWith( "</" ) ) {
+                p += 2;
+                const string_view name = readName();
+                skipSpace();
+                if ( p == end || *p != '>' || stack.empty() || stack.back().name != name )
+                    return false;
+                ++p;
+                setContent( TXmlConfig::valDNE );
+                stack.pop_back();
+                if ( stack.empty() ) // done with the root node
+                    return true;
+            } else {
+                ++p;
+                const string_view name = readName();
+                if ( name.empty() )
+                    return false;
+
+                uint32_t id = 0; // the root node maps to the empty path
+                if ( !stack.empty() ) {
+                    setContent( TXmlConfig::valDNE );
+                    const size_t index = stack.back().siblings[ name ]++ + ( stack.size() == 1 ? rootChildIndex : 0 );
+                    seg.assign( stack.size() > 1 ? TXmlConfig::pathDelim : string() );
+                    seg.append( name.data(), name.size() );
+                    id = mNodes.child( stack.back().id, seg, static_cast<uint32_t>( index ) );
+                }
+
+                // attributes
+                for ( ;; ) {
+                    skipSpace();
+                    if ( p == end ) return false;
+                    if ( *p == '/' || *p == '>' ) break;
+                    const string_view attr = readName();
+                    skipSpace();
+                    if ( attr.empty() || p == end || *p != '=' ) return false;
+                    ++p;
+                    skipSpace();
+                    if ( p == end || ( *p != '"' && *p != '\'' ) ) return false;
+                    const char *q = std::find( p + 1, end, *p );
+                    if ( q == end ) return false;
+                    seg.assign( TXmlConfig::attrDelim );
+                    seg.append( attr.data(), attr.size() );
+                    storeValue( mNodes.child( id, seg, 0 ), unescape( string_view( p + 1, q - p - 1 ), decoded ) );
+                    p = q + 1;
+                }
+
+                stack.push_back( Frame{ id, name, false, {} } );
+                if ( *p == '/' ) { // self closing
+                    ++p;
+                    if ( p == end || *p != '>' ) return false;
+                    setContent( TXmlConfig::valDNE );
+                    stack.pop_back();
+                    if ( stack.empty() )
+                        return true;
+                }
+                ++p;
+            }
+        }
+        return false; // document ended before the root node was closed
+    }
+
+    /**
+     * @brief read a whole file into a string
+     * 
+     * @param filename file to read
+     * @param content filled with the file contents
+     * @return true on success
+     */
+    static bool readFile( const std::string &filename, std::string &content ) {
+        std::ifstream in( filename, std::ios::binary | std::ios::ate );
+        if ( !in )
+            return false;
+        content.resize( static_cast<size_t>( in.tellg() ) );
+        in.seekg( 0 );
+        in.read( &content[0], content.size() );
+        return static_cast<bool>( in );
+    }
+public:
+
+    /**
+     * @brief How load() reads a document
+     * kDOM : parse with TXMLEngine into a DOM, then map it
+     * kStreaming : single pass tokenizer mapping straight into the store, lower peak memory and faster
+     * kMapped : as kStreaming on a memory mapped file, values are views into the mapping (no copies)
+     *           and the file pages are shared by all processes on the host (files only, strings use kStreaming)
+     * kCached : use the binary snapshot "<filename>.bin" if it is newer than the file, otherwise load
+     *           with kMapped and write the snapshot for next time (files only, strings use kStreaming)
+     * kLazy : skim the top level nodes, each is mapped with kStreaming the first time a path inside it is read
+     */
+    enum LoadMode { kDOM, kStreaming, kMapped, kCached, kLazy };
+
+    static int precision; // significant digits written for floating point values, 0 (default) for the shortest exact form
+    static std::string cacheDirectory; // snapshots of remote and compressed sources, "" for none (default $TXMLCONFIG_CACHE)
+    static long cacheMaxAge; // seconds a cached remote source is used without fetching it again
+
+    /**
+     * @brief Returns a path in its cannonical form
+     * 
+     * @param path Path to cannoize, returned in place by reference
+     */
+    static void canonize( std::string &path ) {
+        // remove whitespace
+        path.erase(std::remove_if(path.begin(), path.end(), static_cast<int(*) (int)>(std::isspace)), path.end());
+
+        // removes "[0]" found in paths, so that the first element in a list can be accessed by index 0 or bare path
+        size_t pos = path.find( "[0]" );
+
+        // branchless version using ternary op
+        size_t len = (pos != std::string::npos) ? 3 : 0;
+        pos = (pos != std::string::npos) ? pos : 0;
+        path.erase( pos, len ); // does nothing if "[0]" not found
+        return;
+    }
+
+    /**
+     * @brief dump config to a basic string representation - mostly for debugging
+     * 
+     * @return std::string 
+     */
+    std::string dump() const {
+        std::stringstream ss;
+        dump( ss );
+        return ss.str();
+    }
+
+    /**
+     * @brief dump config entries to a stream as they are visited, without building the whole text first
+     * 
+     * @param os stream to write "[path] = value" lines to
+     * @param prefix only dump this node and its subtree, "" for everything
+     */
+    void dump( std::ostream &os, std::string_view prefix = "" ) const {
+        visit( [&]( std::string_view path, std::string_view value ) {
+            os << "[" << path << "] = " << value << "\n";
+        }, prefix );
+        os.flush();
+    }
+
+    /**
+     * @brief call f( path, value ) for every entry holding a value, in document order
+     * The views are only valid during the call. Nothing is shared between calls, so
+     * concurrent visits of a config that is not being modified are safe.
+     * 
+     * @param f callable taking ( std::string_view path, std::string_view value )
+     * @param prefix only visit this node and its subtree (attributes and child nodes), "" for everything
+     */
+    template <typename F>
+    void visit( F f, std::string_view prefix = "" ) const {
+        uint32_t top = 0;
+        const TXmlConfigStore &nodes = prefix.empty() ? structure() : resolveNode( prefix, top );
+        std::string path;
+        auto emit = [&]( uint32_t i ) {
+            const TXmlConfigStore::Node &n = nodes.node( i );
+            if ( n.val == nullptr || TXmlConfigStore::value( n ) == TXmlConfig::valDNE )
+                return;
+            path.clear();
+            nodes.appendKey( i, path );
+            f( std::string_view( path ), TXmlConfigStore::value( n ) );
+        };
+
+        if ( prefix.empty() ) {
+            // entries are listed in document order
+            for ( uint32_t i = 0; i < nodes.size(); i++ )
+                emit( i );
+            return;
+        }
+
+        if ( top == TXmlConfigStore::npos )
+            return;
+        // depth first through the child index, preorder matches the document
+        std::vector<uint32_t> stack( 1, top );
+        while ( !stack.empty() ) {
+            const uint32_t i = stack.back();
+            stack.pop_back();
+            emit( i );
+            const size_t mark = stack.size();
+            for ( uint32_t c = nodes.node( i ).firstChild; c != TXmlConfigStore::npos; c = nodes.node( c ).nextSibling )
+                stack.push_back( c );
+            std::reverse( stack.begin() + mark, stack.end() );
+        }
+    }
+
+    /**
+     * @brief One entry that differs between two configs, see diff
+     */
+    struct Change {
+        enum Kind { kAdded, kRemoved, kModified };
+        Kind kind;
+        std::string path;
+        std::string oldValue; // empty for kAdded
+        std::string newValue; // empty for kRemoved
+    };
+
+    /**
+     * @brief List the entries that differ between this config and other
+     * Changes are reported in the document order of other, removed entries last.
+     * As in visit(), elements without text are not entries, so a node set() created only to hold
+     * other entries compares equal to the same node loaded from a document.
+     * 
+     * @param other the newer config
+     * @return std::vector<Change> entries added, removed or modified in other
+     */
+    std::vector<Change> diff( const TXmlConfig &other ) const {
+        std::vector<Change> changes;
+        const TXmlConfigStore &mine = structure(), &theirs = other.structure();
+        auto isEntry = []( const TXmlConfigStore::Node &n ) {
+            return n.val != nullptr && TXmlConfigStore::value( n ) != TXmlConfig::valDNE;
+        };
+        std::vector<char> seen( mine.size(), 0 );
+        std::string path;
+        for ( uint32_t i = 0; i < theirs.size(); i++ ) {
+            const TXmlConfigStore::Node &n = theirs.node( i );
+            if ( !isEntry( n ) )
+                continue;
+            path.clear();
+            theirs.appendKey( i, path );
+            const std::string_view val = TXmlConfigStore::value( n );
+            const uint32_t id = mine.findId( path );
+            if ( id == TXmlConfigStore::npos || !isEntry( mine.node( id ) ) ) {
+                changes.push_back( { Change::kAdded, path, std::string(), std::string( val ) } );
+                continue;
+            }
+            seen[ id ] = 1;
+            const std::string_view old = TXmlConfigStore::value( mine.node( id ) );
+            if ( old != val )
+                changes.push_back( { Change::kModified, path, std::string( old ), std::string( val ) } );
+        }
+        for ( uint32_t i = 0; i < mine.size(); i++ ) {
+            const TXmlConfigStore::Node &n = mine.node( i );
+            if ( isEntry( n ) && !seen[ i ] )
+                changes.push_back( { Change::kRemoved, mine.key( i ), std::string( TXmlConfigStore::value( n ) ), std::string() } );
+        }
+        return changes;
+    }
+
+    /**
+     * @brief returns whether or not a path exist
+     * Either node or attribute - used to determine if default value is used
+     * 
+     * @param path - the path to check
+     * @return true : path exists
+     * @return false : path DNE
+     */
+    bool exists( std::string_view path ) const {
+        uint32_t id;
+        locate( path, id );
+        return id != TXmlConfigStore::npos;
+    }
+
+    bool exists( const TXmlConfigPath &path ) const {
+        uint32_t id;
+        locate( path, id );
+        return id != TXmlConfigStore::npos;
+    }
+
+    /**
+     * @brief Generic conversion of type T from string
+     * override this for special conversions
+     * arithmetic types use std::from_chars, anything else goes through a per-thread stringstream,
+     * so conversions never touch shared state and a const config can be read from many threads
+     * 
+     * @tparam T : Type to convert to and return
+     * @param s : input string to use for conversion
+     * @return T converted value of type T
+     */
+    template <typename T>
+    T convert( std::string s ) const {
+        if constexpr ( TXmlConfig::isNumeric<T> ) {
+            T rv{}; // value initialized, as stream extraction leaves it on failure
+            TXmlConfig::fromChars( s, rv );
+            return rv;
+        } else {
+            T rv;
+            std::stringstream &ss = TXmlConfig::threadStream();
+            ss << s;
+            ss >> rv;
+            return rv;
+        }
+    }
+
+    /**
+     * @brief Generic conversion of type T to a string
+     * arithmetic types use std::to_chars, anything else goes through a per-thread stringstream
+     * 
+     * @tparam T : type to convert
+     * @param v : value of type T
+     * @return std::string output string with representation of T
+     */
+    template <typename T>
+    std::string convertTo( T v ) const {
+        if constexpr ( TXmlConfig::isNumeric<T> ) {
+            return TXmlConfig::toChars( v );
+        } else {
+            std::stringstream &ss = TXmlConfig::threadStream();
+            ss << v;
+            return ss.str();
+        }
+    }
+
+
+    /**
+     * @brief template function for getting any type that can be converted from string via stringstream
+     * 
+     * @tparam T type to return 
+     * @param path path to lookup
+     * @param dv default value to return if the node DNE
+     * @return T return value of type T
+     */
+    template <typename T>
+    T get( std::string path, T dv ) const {
+        // convrt from string to type T and return, or the default value if path DNE
+        return read( path, [&]( const TXmlConfig *c, uint32_t id ) { return c->valueOf<T>( id, dv ); } );
+    }
+
+    /**
+     * @brief get from a string literal or view without copying the path
+     * numeric and string types are looked up straight from the view, other types go through
+     * get( std::string, T ) so that specializations of it (e.g. get<TH1*>) are still used
+     * 
+     * @tparam T type to return 
+     * @param path path to lookup, only copied if it needs canonizing
+     * @param dv default value to return if the node DNE
+     * @return T return value of type T
+     */
+    template <typename T>
+    T get( std::string_view path, T dv ) const {
+        if constexpr ( TXmlConfig::isPlain<T> ) {
+            return read( path, [&]( const TXmlConfig *c, uint32_t id ) { return c->valueOf<T>( id, dv ); } );
+        } else {
+            return get<T>( std::string( path ), dv );
+        }
+    }
+
+    template <typename T>
+    T get( const char *path, T dv ) const {
+        return get<T>( std::string_view( path ), dv );
+    }
+
+    /**
+     * @brief get with a path hashed at compile time, e.g. cfg.get<double>( TXML_PATH( "Cuts.Track:ptMin" ), 0.2 )
+     * 
+     * @tparam T type to return
+     * @param path canonical path with its precomputed hash
+     * @param dv default value to return if the node DNE
+     * @return T return value of type T
+     */
+    template <typename T>
+    T get( const TXmlConfigPath &path, T dv ) const {
+        if constexpr ( TXmlConfig::isPlain<T> ) {
+            return read( path, [&]( const TXmlConfig *c, uint32_t id ) { return c->valueOf<T>( id, dv ); } );
+        } else {
+            return get<T>( std::string( path.path() ), dv );
+        }
+    }
+
+    /**
+     * @brief Writes a value of type T to the map
+     * Uses convertTo<T> to convert type T to a string rep 
+     * @tparam T type of value to write
+     * @param path path to write to
+     * @param v value of type T
+     */
+    template <typename T>
+    void set( std::string path, T v ) {
+        // convrt from type T to string and write
+        write( path, convertTo<T>( v ) );
+    }
+
+    /**
+     * @brief set from a string literal or view without copying the path
+     * numeric and string types are written directly, other types go through set( std::string, T )
+     * 
+     * @tparam T type of value to write
+     * @param path path to write to, only copied if it needs canonizing
+     * @param v value of type T
+     */
+    template <typename T>
+    void set( std::string_view path, T v ) {
+        if constexpr ( std::is_same<T, bool>::value )
+            write( path, v ? "true" : "false" );
+        else if constexpr ( std::is_same<T, std::string>::value || std::is_same<T, std::string_view>::value )
+            write( path, v );
+        else if constexpr ( std::is_arithmetic<T>::value )
+            write( path, convertTo<T>( v ) );
+        else
+            set<T>( std::string( path ), v );
+    }
+
+    template <typename T>
+    void set( const char *path, T v ) {
+        set<T>( std::string_view( path ), v );
+    }
+
+    /**
+     * @brief Write a list of numbers as one comma separated value, formatted into a single buffer
+     * Reads back with getVector<T>, floating point values exactly unless TXmlConfig::precision is set.
+     * 
+     * @tparam T arithmetic type of the elements, bool is written as true / false
+     * @param path path to write to
+     * @param v first element
+     * @param n number of elements
+     */
+    template <typename T>
+    void setVector( std::string_view path, const T *v, size_t n ) {
+        static_assert( std::is_arithmetic<T>::value, "setVector: elements must be arithmetic" );
+        std::string buf;
+        buf.reserve( n * ( std::is_floating_point<T>::value ? 26 : 12 ) );
+        for ( size_t i = 0; i < n; i++ ) {
+            if ( i )
+                buf.append( ", " );
+            if constexpr ( std::is_same<T, bool>::value )
+                buf.append( v[ i ] ? "true" : "false" );
+            else
+                TXmlConfig::appendChars( buf, v[ i ] );
+        }
+        write( path, buf );
+    }
+
+    template <typename T>
+    void setVector( std::string_view path, const std::vector<T> &v ) {
+        if constexpr ( std::is_same<T, bool>::value ) {
+            // std::vector<bool> has no data()
+            std::string buf;
+            for ( size_t i = 0; i < v.size(); i++ )
+                buf.append( i ? ", " : "" ).append( v[ i ] ? "true" : "false" );
+            write( path, buf );
+        } else {
+            setVector<T>( path, v.data(), v.size() );
+        }
+    }
+
+    /**
+     * @brief A set of writes collected up front and applied together by update()
+     * Paths are canonized and values converted when added, bool as "true" / "false",
+     * strings as is and everything else like convertTo.
+     */
+    class Batch {
+    public:
+        template <typename T>
+        Batch &set( std::string_view path, const T &v ) {
+            std::string p( path );
+            TXmlConfig::canonize( p );
+            if constexpr ( std::is_same<T, bool>::value ) {
+                mEntries.emplace_back( std::move( p ), v ? "true" : "false" );
+            } else if constexpr ( std::is_convertible<const T &, std::string_view>::value ) {
+                mEntries.emplace_back( std::move( p ), std::string( std::string_view( v ) ) );
+            } else if constexpr ( TXmlConfig::isNumeric<T> ) {
+                mEntries.emplace_back( std::move( p ), TXmlConfig::toChars( v ) );
+            } else {
+                std::stringstream &ss = TXmlConfig::threadStream();
+                ss << v;
+                mEntries.emplace_back( std::move( p ), ss.str() );
+            }
+            return *this;
+        }
+
+        size_t size() const { return mEntries.size(); }
+        bool empty() const { return mEntries.empty(); }
+        const std::vector<std::pair<std::string, std::string>> &entries() const { return mEntries; }
+
+    protected:
+        std::vector<std::pair<std::string, std::string>> mEntries; // canonical path, value
+    };
+
+    /**
+     * @brief Apply a batch of writes in one pass
+     * Writes to the same path collapse to the last one, caches and handles are refreshed once
+     * for the whole batch. New nodes are created in the order of their first write, as by the same set() calls.
+     * Like set(), this must not race with readers of this config,
+     * see TXmlConfigLive::update to publish a batch to concurrent readers.
+     * 
+     * @param batch writes to apply
+     */
+    void update( const Batch &batch ) {
+        const auto &entries = batch.entries();
+        // the last write to a path wins, written where the path is first written
+        std::unordered_map<std::string_view, size_t> last;
+        last.reserve( entries.size() );
+        for ( size_t i = 0; i < entries.size(); i++ )
+            last[ entries[ i ].first ] = i;
+        for ( const auto &e : entries ) {
+            auto it = last.find( e.first );
+            if ( it == last.end() )
+                continue; // written already
+            const uint32_t id = mNodes.set( e.first, entries[ it->second ].second );
+            mTypedCache.invalidate( id, mNodes.size() );
+            last.erase( it );
+        }
+        mAccessStats.resize( mNodes.size() );
+        mFlat.reset();
+        mGeneration = nextGeneration();
+    }
+
+    /**
+     * @brief Apply string values in one pass, e.g. cfg.update( { { "Tpc:gain", "1.05" }, { "Job:name", "test" } } )
+     */
+    void update( std::initializer_list<std::pair<std::string_view, std::string_view>> values ) {
+        Batch batch;
+        for ( const auto &v : values )
+            batch.set( v.first, v.second );
+        update( batch );
+    }
+    
+    /**
+     * @brief Get a Vector object from config
+     * 
+     * @tparam T type of value for the vector object
+     * @param path path to lookup
+     * @param dv default value, can use initializer list
+     * @return std::vector<T> vector of type T returned
+     */
+    template <typename T>
+    std::vector<T> getVector( std::string path, std::vector<T> dv ) const {
+        return read( path, [&]( const TXmlConfig *c, uint32_t id ) { return c->vectorOf<T>( id, dv ); } );
+    }
+
+    /**
+     * @brief getVector from a string literal or view without copying the path
+     * numeric and string element types are looked up straight from the view,
+     * others go through getVector( std::string, std::vector<T> )
+     */
+    template <typename T>
+    std::vector<T> getVector( std::string_view path, std::vector<T> dv ) const {
+        if constexpr ( TXmlConfig::isPlain<T> ) {
+            return read( path, [&]( const TXmlConfig *c, uint32_t id ) { return c->vectorOf<T>( id, dv ); } );
+        } else {
+            return getVector<T>( std::string( path ), dv );
+        }
+    }
+
+    template <typename T>
+    std::vector<T> getVector( const char *path, std::vector<T> dv ) const {
+        return getVector<T>( std::string_view( path ), dv );
+    }
+
+    template <typename T>
+    std::vector<T> getVector( const TXmlConfigPath &path, std::vector<T> dv ) const {
+        if constexpr ( TXmlConfig::isPlain<T> ) {
+            return read( path, [&]( const TXmlConfig *c, uint32_t id ) { return c->vectorOf<T>( id, dv ); } );
+        } else {
+            return getVector<T>( std::string( path.path() ), dv );
+        }
+    }
+
+    /**
+     * @brief Get a vector from config into caller provided storage, reusing its capacity
+     * 
+     * @tparam T type of value for the vector object
+     * @param path path to lookup
+     * @param out cleared and filled with the elements, untouched if the path DNE
+     * @return true if the path exists
+     * The list is always parsed straight into out, the typed cache would hand back a copy to copy again
+     */
+    template <typename T>
+    bool getVectorInto( std::string_view path, std::vector<T> &out ) const {
+        return read( path, [&]( const TXmlConfig *c, uint32_t id ) {
+            if ( id == TXmlConfigStore::npos )
+                return false;
+            out.clear();
+            splitList( TXmlConfigStore::value( c->mNodes.node( id ) ), [&]( std::string_view elem ) { out.push_back( convertElement<T>( elem ) ); } );
+            return true;
+        } );
+    }
+
+    /**
+     * @brief Get a vector from config into a caller provided buffer, without allocating
+     * 
+     * @tparam T type of value for the vector object
+     * @param path path to lookup
+     * @param out buffer for at least n elements
+     * @param n capacity of out, the first n elements are written
+     * @return size_t number of elements in the list, 0 if the path DNE. Like snprintf, more than n means
+     * the list was truncated to n elements
+     */
+    template <typename T>
+    size_t getVectorInto( std::string_view path, T *out, size_t n ) const {
+        return read( path, [&]( const TXmlConfig *c, uint32_t id ) {
+            size_t count = 0;
+            if ( id == TXmlConfigStore::npos )
+                return count;
+            splitList( TXmlConfigStore::value( c->mNodes.node( id ) ), [&]( std::string_view elem ) {
+                if ( count < n )
+                    out[ count ] = convertElement<T>( elem );
+                count++;
+            } );
+            return count;
+        } );
+    }
+
+    /**
+     * @brief Get a vector from config into a std::array, without allocating
+     * 
+     * @return size_t number of elements in the list, 0 if the path DNE, more than N if it was truncated to N
+     */
+    template <typename T, size_t N>
+    size_t getVectorInto( std::string_view path, std::array<T, N> &out ) const {
+        return getVectorInto<T>( path, out.data(), N );
+    }
+
+    /**
+     * @brief Turn the typed value cache on or off (off by default)
+     * When on, the first get<T> / getVector<T> of a numeric type on a node memoizes the converted value,
+     * later reads of the same node and type skip parsing. Safe with concurrent const readers,
+     * the memo of a node is dropped when set() writes to it and everything is dropped by load().
+     * kLazy sections share the setting, whether they are mapped before or after the call.
+     * 
+     * @param on true to enable
+     */
+    void enableTypedCache( bool on = true ) {
+        mTypedCache.enable( on );
+        mTypedCache.invalidate( 0, mNodes.size() );
+        if ( mLazy ) {
+            // sections mapped so far, later ones pick the setting up in section()
+            for ( auto &sec : mLazy->sections )
+                if ( sec->cfg )
+                    sec->cfg->enableTypedCache( on );
+        }
+    }
+
+    using MemoryUsage = TXmlConfigStore::Usage;
+
+    /**
+     * @brief Memory held by the values of this config, not counting a parent or kLazy nodes not defined by set()
+     * e.g. cfg.memoryUsage().total(), or placeholders for the elements without text
+     */
+    MemoryUsage memoryUsage() const {
+        return mNodes.usage( TXmlConfig::valDNE );
+    }
+
+    /**
+     * @brief Rebuild the storage once loading and set() are done, storing every distinct value once
+     * Placeholders of elements without text and repeated values (units, flags, common binnings) then share
+     * one copy, and values of kMapped / kCached loads are copied so the file mapping is released.
+     * string_view values read before are invalidated, handles refresh themselves.
+     */
+    void compact() {
+        mNodes.compact();
+        mFlat.reset();
+        mGeneration = nextGeneration();
+    }
+
+    /**
+     * @brief Turn read instrumentation on or off (off by default, costing a branch per read)
+     * When on, get / getVector / getVectorInto count reads and conversion time per path and
+     * remember which missing paths returned their default value, see accessStats and accessReport.
+     * Reads through Key handles are counted too, with no conversion time. Overlays count defaults themselves,
+     * reads that fall through are counted by the parent if it has stats enabled.
+     * kLazy sections count their own reads, copies of a lazy config share those counts.
+     * 
+     * @param on true to enable, false also drops the counts
+     */
+    void enableAccessStats( bool on = true ) {
+        mAccessStats.enable( on );
+        mAccessStats.resize( mNodes.size() );
+        if ( mLazy ) {
+            // sections mapped so far, later ones pick the setting up in section()
+            for ( auto &sec : mLazy->sections )
+                if ( sec->cfg )
+                    sec->cfg->enableAccessStats( on );
+        }
+    }
+
+    /**
+     * @brief Read statistics of one path
+     */
+    struct AccessStat {
+        std::string path;
+        uint64_t reads = 0;    // reads that found the path
+        uint64_t defaults = 0; // reads that returned the default value since the path DNE
+        uint64_t ns = 0;       // total time of the reads that found the path, conversions included
+    };
+
+    /**
+     * @brief statistics of every stored path and every defaulted path, most read first
+     * stored paths never read are listed with 0 reads, dead config is at the end.
+     * kLazy: every section is mapped, so paths in sections nobody read are listed too
+     */
+    std::vector<AccessStat> accessStats() const {
+        std::vector<AccessStat> stats;
+        for ( uint32_t i = 0; i < mNodes.size(); i++ ) {
+            if ( mNodes.node( i ).val == nullptr )
+                continue;
+            AccessStat a;
+            a.path = mNodes.key( i );
+            a.reads = mAccessStats.reads( i );
+            a.ns = mAccessStats.nanoseconds( i );
+            stats.push_back( a );
+        }
+        if ( mLazy ) {
+            for ( auto &sec : mLazy->sections ) {
+                const TXmlConfig &c = section( *sec );
+                for ( uint32_t i = 0; i < c.mNodes.size(); i++ ) {
+                    if ( c.mNodes.node( i ).val == nullptr )
+                        continue;
+                    AccessStat a;
+                    a.path = c.mNodes.key( i );
+                    if ( findValue( a.path ) != TXmlConfigStore::npos )
+                        continue; // set() on this config hides the section value, listed above
+                    a.reads = c.mAccessStats.reads( i );
+                    a.ns = c.mAccessStats.nanoseconds( i );
+                    stats.push_back( a );
+                }
+            }
+        }
+        for ( auto &d : mAccessStats.defaults() ) {
+            AccessStat a;
+            a.path = d.first;
+            a.defaults = d.second;
+            stats.push_back( a );
+        }
+        std::stable_sort( stats.begin(), stats.end(), []( const AccessStat &a, const AccessStat &b ) {
+            return a.reads + a.defaults > b.reads + b.defaults;
+        } );
+        return stats;
+    }
+
+    /**
+     * @brief human readable summary of accessStats, e.g. printed at the end of a job
+     * 
+     * @param top number of most read paths to list
+     * @return std::string report
+     */
+    std::string accessReport( size_t top = 20 ) const {
+        using namespace std;
+        const vector<AccessStat> stats = accessStats();
+        stringstream ss;
+        ss << "most read paths:" << endl;
+        size_t listed = 0;
+        for ( size_t i = 0; i < stats.size() && listed < top; i++ ) {
+            if ( stats[ i ].reads == 0 )
+                continue;
+            ss << "  " << stats[ i ].path << " : " << stats[ i ].reads << " reads, " << stats[ i ].ns / stats[ i ].reads << " ns / read" << endl;
+            listed++;
+        }
+        ss << "read but missing, default value used:" << endl;
+        for ( const AccessStat &a : stats )
+            if ( a.defaults > 0 )
+                ss << "  " << a.path << " : " << a.defaults << " reads" << endl;
+        ss << "never read:" << endl;
+        for ( const AccessStat &a : stats )
+            if ( a.reads == 0 && a.defaults == 0 ) {
+                uint32_t id;
+                const TXmlConfig *c = locate( a.path, id );
+                if ( TXmlConfigStore::value( c->mNodes.node( id ) ) != TXmlConfig::valDNE )
+                    ss << "  " << a.path << endl;
+            }
+        return ss.str();
+    }
+
+    /**
+     * @brief Lightweight reference to a node of the config, as yielded by children()
+     * Valid until the next load() of the config it came from. On overlays and kLazy configs it shares
+     * the merged store it points into, so a later set() does not invalidate it (it keeps the old values)
+     */
+    class NodeRef {
+        friend class TXmlConfig;
+    public:
+        NodeRef( std::shared_ptr<const TXmlConfigStore> store, uint32_t id ) : mStore( std::move( store ) ), mId( id ) {}
+
+        /**
+         * @brief the node name, without path delimiter or array index
+         */
+        std::string_view name() const {
+            const TXmlConfigStore::Node &n = mStore->node( mId );
+            std::string_view seg( n.seg, n.segLen );
+            return ( !seg.empty() && seg[0] == '.' ) ? seg.substr( 1 ) : seg;
+        }
+        /**
+         * @brief array index among repeated siblings, 0 for the first
+         */
+        uint32_t index() const { return mStore->node( mId ).index; }
+        /**
+         * @brief the full canonical path of the node (allocates)
+         */
+        std::string path() const { return mStore->key( mId ); }
+        /**
+         * @brief append the full canonical path of the node to out
+         */
+        void appendPath( std::string &out ) const { mStore->appendKey( mId, out ); }
+        /**
+         * @brief whether the node holds a value, false for nodes only implied by deeper paths
+         */
+        bool exists() const { return mStore->node( mId ).val != nullptr; }
+        /**
+         * @brief the stored value, empty if the node holds none
+         * A view into the store, see get<std::string_view> for how long it stays valid
+         */
+        std::string_view value() const { return TXmlConfigStore::value( mStore->node( mId ) ); }
+        uint32_t id() const { return mId; }
+
+    protected:
+        std::shared_ptr<const TXmlConfigStore> mStore;
+        uint32_t mId;
+    };
+
+    /**
+     * @brief Range over the child nodes (not attributes) of a node, in document order, without allocating
+     */
+    class ChildRange {
+    public:
+        class iterator {
+        public:
+            // store is the one of the range, which must outlive its iterators
+            iterator( const std::shared_ptr<const TXmlConfigStore> &store, uint32_t id ) : mStore( &store ), mId( id ) { skipAttributes(); }
+            NodeRef operator*() const { return NodeRef( *mStore, mId ); }
+            iterator &operator++() {
+                mId = ( *mStore )->node( mId ).nextSibling;
+                skipAttributes();
+                return *this;
+            }
+            bool operator==( const iterator &o ) const { return mId == o.mId; }
+            bool operator!=( const iterator &o ) const { return mId != o.mId; }
+
+        protected:
+            void skipAttributes() {
+                while ( mId != TXmlConfigStore::npos && ( *mStore )->isAttribute( mId ) )
+                    mId = ( *mStore )->node( mId ).nextSibling;
+            }
+            const std::shared_ptr<const TXmlConfigStore> *mStore;
+            uint32_t mId;
+        };
+
+        ChildRange( std::shared_ptr<const TXmlConfigStore> store, uint32_t parent )
+            : mStore( std::move( store ) ), mFirst( parent == TXmlConfigStore::npos ? parent : mStore->node( parent ).firstChild ) {}
+        iterator begin() const { return iterator( mStore, mFirst ); }
+        iterator end() const { return iterator( mStore, TXmlConfigStore::npos ); }
+        bool empty() const { return begin() == end(); }
+
+    protected:
+        std::shared_ptr<const TXmlConfigStore> mStore;
+        uint32_t mFirst;
+    };
+
+    /**
+     * @brief iterate the child nodes of a given node
+     * e.g. for ( auto h : cfg.children( "Histograms" ) ) { h.path(); h.name(); h.index(); }
+     * 
+     * @param path path to search for children
+     * @return ChildRange range of NodeRef, empty if path DNE
+     */
+    ChildRange children( std::string_view path ) const {
+        // kLazy: a path inside one section only maps that section, overlays merge only this subtree
+        uint32_t id;
+        std::shared_ptr<const TXmlConfigStore> nodes = resolveNodePtr( path, id );
+        return ChildRange( std::move( nodes ), id );
+    }
+
+    /**
+     * @brief list the paths of children nodes for a given node
+     * Only direct children are listed (not attributes), in document order,
+     * using the child index of the store so the cost follows the number of children
+     * 
+     * @param path path to search for children
+     * @return std::vector<std::string> list of full paths to the children nodes
+     */
+    std::vector<std::string> childrenOf( std::string_view path ) const {
+        std::vector<std::string> result;
+        for ( NodeRef child : children( path ) )
+            result.push_back( child.path() );
+        return result;
+    }
+
+    /**
+     * @brief Find the nodes matching a path pattern, in document order
+     * Each level of the pattern is a name or "*" (any name), optionally followed by an index:
+     * "[3]" one index, "[0..11]" an inclusive range or "[*]" any index. Without an index a name means
+     * index 0 like everywhere else, while a bare "*" matches every child. e.g.
+     * cfg.query( "Detector.Sector[*].Module[0..9]:gain" ), cfg.query( "Histograms.*:name" )
+     * Only the children of nodes matched so far are looked at, named levels with explicit indices are direct lookups.
+     * 
+     * @param pattern path pattern
+     * @return std::vector<NodeRef> matching nodes, empty if none match or the pattern is malformed
+     */
+    std::vector<NodeRef> query( std::string_view pattern ) const {
+        struct Step {
+            char delim;
+            std::string_view name; // "*" for any
+            uint32_t first = 0, last = 0;
+            bool anyIndex = false;
+        };
+        std::string p;
+        for ( char c : pattern )
+            if ( !std::isspace( static_cast<unsigned char>( c ) ) )
+                p += c;
+
+        // split into steps
+        std::vector<Step> steps;
+        size_t firstEnd = 0; // end of the first step in p
+        for ( size_t i = 0; i < p.size(); ) {
+            Step st;
+            st.delim = '.';
+            if ( p[ i ] == '.' || p[ i ] == ':' )
+                st.delim = p[ i++ ];
+            const size_t end = p.find_first_of( ".:[", i );
+            st.name = std::string_view( p ).substr( i, end == std::string::npos ? std::string::npos : end - i );
+            i += st.name.size();
+            if ( st.name.empty() )
+                return {};
+            st.anyIndex = st.name == "*";
+            if ( i < p.size() && p[ i ] == '[' ) {
+                const size_t close = p.find( ']', i );
+                if ( close == std::string::npos )
+                    return {};
+                const std::string_view idx = std::string_view( p ).substr( i + 1, close - i - 1 );
+                i = close + 1;
+                st.anyIndex = idx == "*";
+                if ( !st.anyIndex ) {
+                    const size_t dots = idx.find( ".." );
+                    const std::string_view a = idx.substr( 0, dots );
+                    const std::string_view b = dots == std::string_view::npos ? a : idx.substr( dots + 2 );
+                    if ( std::from_chars( a.data(), a.data() + a.size(), st.first ).ptr != a.data() + a.size() ||
+                         std::from_chars( b.data(), b.data() + b.size(), st.last ).ptr != b.data() + b.size() || a.empty() || b.empty() )
+                        return {};
+                }
+            }
+            if ( !steps.empty() && steps.back().delim == ':' )
+                return {}; // attributes have no children
+            steps.push_back( st );
+            if ( steps.size() == 1 )
+                firstEnd = i;
+        }
+
+        // kLazy: query only the sections the first level matches, unless set() changed the config
+        if ( mLazy && !mParent && mNodes.size() == mLazy->rootNodes && !steps.empty() && steps[0].delim == '.' ) {
+            std::vector<NodeRef> result;
+            for ( auto &sec : mLazy->sections ) {
+                const std::string_view name = std::string_view( sec->key ).substr( 0, sec->key.find( '[' ) );
+                if ( ( steps[0].name != "*" && steps[0].name != name ) ||
+                     ( !steps[0].anyIndex && ( sec->index < steps[0].first || sec->index > steps[0].last ) ) )
+                    continue;
+                for ( NodeRef &n : section( *sec ).query( sec->key + p.substr( firstEnd ) ) ) {
+                    n.mStore = std::shared_ptr<const TXmlConfigStore>( mLazy, n.mStore.get() ); // the section lives in mLazy
+                    result.push_back( std::move( n ) );
+                }
+            }
+            return result;
+        }
+
+        // start at the node the leading literal steps name, overlays then merge only the subtree below it
+        size_t literal = 0;
+        std::string prefix;
+        char buf[16];
+        for ( ; literal < steps.size(); literal++ ) {
+            const Step &st = steps[ literal ];
+            if ( st.delim != '.' || st.name == "*" || st.anyIndex || st.first != st.last )
+                break;
+            if ( literal > 0 )
+                prefix += TXmlConfig::pathDelim;
+            prefix.append( st.name.data(), st.name.size() );
+            if ( st.first )
+                prefix.append( buf, TXmlConfigStore::formatIndex( st.first, buf ) );
+        }
+        uint32_t start = 0;
+        const std::shared_ptr<const TXmlConfigStore> store = prefix.empty() ? structurePtr() : resolveNodePtr( prefix, start );
+        if ( start == TXmlConfigStore::npos )
+            return {};
+        const TXmlConfigStore &nodes = *store;
+        std::vector<uint32_t> current( 1, start ), next;
+        std::string seg;
+        for ( size_t s = literal; s < steps.size(); s++ ) {
+            const Step &st = steps[ s ];
+            next.clear();
+            for ( uint32_t parent : current ) {
+                if ( st.name != "*" && !st.anyIndex && st.last - st.first < 64 ) {
+                    // literal name and a few indices, look them up directly
+                    seg.assign( st.delim == ':' ? TXmlConfig::attrDelim : ( parent == 0 ? std::string() : TXmlConfig::pathDelim ) );
+                    seg.append( st.name.data(), st.name.size() );
+                    for ( uint32_t index = st.first; index <= st.last; index++ ) {
+                        const uint32_t id = nodes.findChild( parent, seg, index );
+                        if ( id != TXmlConfigStore::npos )
+                            next.push_back( id );
+                        if ( index == UINT32_MAX )
+                            break;
+                    }
+                    continue;
+                }
+                for ( uint32_t c = nodes.node( parent ).firstChild; c != TXmlConfigStore::npos; c = nodes.node( c ).nextSibling ) {
+                    const TXmlConfigStore::Node &n = nodes.node( c );
+                    if ( nodes.isAttribute( c ) != ( st.delim == ':' ) )
+                        continue;
+                    std::string_view name( n.seg, n.segLen );
+                    if ( !name.empty() && ( name[0] == '.' || name[0] == ':' ) )
+                        name.remove_prefix( 1 );
+                    if ( st.name != "*" && st.name != name )
+                        continue;
+                    if ( !st.anyIndex && ( n.index < st.first || n.index > st.last ) )
+                        continue;
+                    next.push_back( c );
+                }
+            }
+            current.swap( next );
+        }
+
+        std::vector<NodeRef> result;
+        result.reserve( current.size() );
+        for ( uint32_t id : current )
+            if ( id != 0 )
+                result.push_back( NodeRef( store, id ) );
+        return result;
+    }
+
+    /**
+     * @brief One output column of getColumns: an attribute (":gain") or child node (".Alignment") name,
+     * the vector to fill and the value used for rows that lack it
+     */
+    template <typename T>
+    struct Column {
+        std::string name;
+        std::vector<T> *out;
+        T dv;
+    };
+
+    /**
+     * @brief describe a column for getColumns, a name without delimiter is taken as an attribute
+     */
+    template <typename T>
+    static Column<T> column( std::string name, std::vector<T> &out, T dv = T() ) {
+        if ( name.empty() || ( name[0] != ':' && name[0] != '.' ) )
+            name = TXmlConfig::attrDelim + name;
+        return Column<T>{ name, &out, dv };
+    }
+
+    /**
+     * @brief Fill columns from every repetition of a node in one scan
+     * Row i holds path[i], e.g. for <Channel id=".." gain=".."/> repeated below Pedestals
+     * @code
+     * std::vector<int> id; std::vector<float> gain;
+     * size_t n = cfg.getColumns( "Pedestals.Channel", TXmlConfig::column( "id", id ), TXmlConfig::column( "gain", gain, 1.0f ) );
+     * @endcode
+     * Large tables are converted in parallel, unless a column is std::vector<bool>.
+     * 
+     * @param path path of the repeated node, without index
+     * @param columns columns to fill, each vector is resized to the number of rows
+     * @return size_t number of rows, 0 if path DNE
+     */
+    template <typename... Ts>
+    size_t getColumns( std::string_view path, Column<Ts>... columns ) const {
+        std::vector<uint32_t> rows;
+        const TXmlConfigStore &nodes = tableRows( path, rows );
+        ( columns.out->assign( rows.size(), columns.dv ), ... );
+
+        auto fill = [&]( size_t begin, size_t end ) {
+            for ( size_t r = begin; r < end; r++ ) {
+                for ( uint32_t c = nodes.node( rows[ r ] ).firstChild; c != TXmlConfigStore::npos; c = nodes.node( c ).nextSibling ) {
+                    const TXmlConfigStore::Node &n = nodes.node( c );
+                    if ( n.val == nullptr )
+                        continue;
+                    const std::string_view seg( n.seg, n.segLen );
+                    ( ( seg == columns.name ? (void)( ( *columns.out )[ r ] = convertElement<Ts>( TXmlConfigStore::value( n ) ) ) : (void)0 ), ... );
+                }
+            }
+        };
+        const size_t chunk = 4096;
+        // std::vector<bool> packs neighbouring rows into one word, so bool columns are filled by one thread
+        constexpr bool concurrent = !( std::is_same<Ts, bool>::value || ... );
+        if ( rows.size() <= chunk || !concurrent )
+            fill( 0, rows.size() );
+        else
+            parallelFor( ( rows.size() + chunk - 1 ) / chunk, 0, [&]( size_t i ) { fill( i * chunk, std::min( rows.size(), ( i + 1 ) * chunk ) ); } );
+        return rows.size();
+    }
+
 protected:
+    /**
+     * @brief ids of every repetition of the node at path, ordered by index
+     *
+     * @param path path of the repeated node, without index
+     * @param rows set to the node ids
+     * @return const TXmlConfigStore& the structure() the ids refer to, the one below the parent of path
+     */
+    const TXmlConfigStore &tableRows( std::string_view path, std::vector<uint32_t> &rows ) const {
+        std::string p( path );
+        TXmlConfig::canonize( p );
+        const size_t up = p.find_last_of( ".:" );
+        const TXmlConfigStore &nodes = structure( up == std::string::npos ? std::string_view() : std::string_view( p ).substr( 0, up ) );
+        rows.clear();
+        const uint32_t first = nodes.findId( p );
+        if ( first != TXmlConfigStore::npos && nodes.node( first ).parent != TXmlConfigStore::npos ) {
+            // repetitions are the siblings with the same segment, ordered by their index
+            const TXmlConfigStore::Node &f = nodes.node( first );
+            const std::string_view seg( f.seg, f.segLen );
+            for ( uint32_t c = nodes.node( f.parent ).firstChild; c != TXmlConfigStore::npos; c = nodes.node( c ).nextSibling )
+                if ( std::string_view( nodes.node( c ).seg, nodes.node( c ).segLen ) == seg )
+                    rows.push_back( c );
+            std::stable_sort( rows.begin(), rows.end(), [&]( uint32_t a, uint32_t b ) { return nodes.node( a ).index < nodes.node( b ).index; } );
+        }
+        return nodes;
+    }
 
-    static const std::string valDNE; // used for nodes that DNE
-    static const std::string pathDelim; // separate node levels
-    static const std::string attrDelim; // separate attributes on nodes
+public:
+    /**
+     * @brief Precompiled handle to a single config value
+     * The path is canonized and looked up once and the converted value is cached,
+     * so repeated reads cost a generation check and a dereference.
+     * The cached value is refreshed on the next read after load(), set() or an assignment changed the config.
+     * A handle refers to its config by pointer: it must not outlive it, and it should be owned
+     * by a single reader (copies are cheap) since a refresh writes to the handle.
+     * With access statistics enabled every read is counted like a get(), without a conversion time.
+     * 
+     * @tparam T type of the value, converted with convert<T>
+     */
+    template <typename T>
+    class Key {
+    public:
+        Key() {}
+
+        /**
+         * @brief Construct a handle and resolve it immediately
+         * 
+         * @param cfg config to read from
+         * @param path path to lookup
+         * @param dv default value used while the path DNE
+         */
+        Key( const TXmlConfig &cfg, std::string path, T dv ) : mConfig( &cfg ), mPath( path ), mDefault( dv ), mValue( dv ) {
+            TXmlConfig::canonize( mPath );
+            mHash = TXmlConfigStore::hashKey( mPath );
+            refresh();
+        }
+
+        /**
+         * @brief the current value, refreshed first if the config changed
+         * 
+         * @return const T& cached value or the default if the path DNE
+         */
+        const T &get() const {
+            if ( mGeneration != mConfig->mGeneration )
+                refresh();
+            if ( mId != TXmlConfigStore::npos ) {
+                if ( mHolder->mAccessStats.enabled() )
+                    mHolder->mAccessStats.read( mId, 0 );
+            } else if ( mConfig->mAccessStats.enabled() ) {
+                mConfig->mAccessStats.defaulted( mPath, mHash );
+            }
+            return mValue;
+        }
+
+        const T &operator*() const { return get(); }
+        const T *operator->() const { return &get(); }
+        operator const T &() const { return get(); }
+
+        /**
+         * @brief whether the path existed when the handle was last refreshed
+         */
+        bool exists() const {
+            get();
+            return mExists;
+        }
+
+        /**
+         * @brief the canonical path of this handle
+         */
+        const std::string &path() const { return mPath; }
+
+    private:
+        void refresh() const {
+            std::string_view val;
+            mExists = mConfig->find( mPath, val );
+            mHolder = mConfig->locate( mPath, mId ); // where reads are counted, see TXmlConfig::read
+            if constexpr ( std::is_same<T, std::string_view>::value )
+                mValue = mExists ? val : mDefault; // a view into the store, no conversion
+            else
+                mValue = mExists ? mConfig->convert<T>( std::string( val ) ) : mDefault;
+            mGeneration = mConfig->mGeneration;
+        }
+
+        const TXmlConfig *mConfig = nullptr;
+        std::string mPath;
+        uint64_t mHash = 0;
+        T mDefault{};
+        mutable T mValue{};
+        mutable bool mExists = false;
+        mutable uint64_t mGeneration = 0;
+        mutable const TXmlConfig *mHolder = nullptr; // config holding the value, for access statistics
+        mutable uint32_t mId = TXmlConfigStore::npos;
+    };
+
+    /**
+     * @brief Create a precompiled handle for repeated reads of one path
+     * 
+     * @tparam T type to return
+     * @param path path to lookup
+     * @param dv default value to return if the node DNE
+     * @return Key<T> handle, valid as long as this config
+     */
+    template <typename T>
+    Key<T> handle( std::string path, T dv ) const {
+        return Key<T>( *this, path, dv );
+    }
+
+    /**
+     * @brief Constructor is noop, use load(...)
+     * 
+     */
+    TXmlConfig() {}
+
+    /**
+     * @brief Construct a new Fwd Tracker Config object and load a file
+     * 
+     * @param filename 
+     */
+    TXmlConfig(std::string filename) {
+        load( filename );
+    }
+
+    /**
+     * @brief Construct an overlay on a shared, immutable parent config
+     * The overlay holds only what is set() or load()ed into it, every other path is read from the parent,
+     * so a variant costs memory and time in the number of overrides. The parent must not change afterwards.
+     * 
+     * @param parent config to fall through to, may itself be an overlay
+     */
+    explicit TXmlConfig( std::shared_ptr<const TXmlConfig> parent ) : mParent( parent ) {}
+
+    /**
+     * @brief the config this overlay falls through to, nullptr if it is not an overlay
+     */
+    std::shared_ptr<const TXmlConfig> parent() const { return mParent; }
+
+    /**
+     * @brief A standalone copy of this config, overlays merged with all their parents
+     */
+    TXmlConfig flatten() const {
+        TXmlConfig flat;
+        flat.mNodes = structure();
+        flat.mErrorParsing = mErrorParsing;
+        return flat;
+    }
+
+    /**
+     * @brief The config as an xml document, attributes and repeated nodes included
+     * Loading the document again gives the same config, see diff(). Repeated nodes are written in index order,
+     * and nodes without text, like those set() creates to hold other entries or indices missing below a set()
+     * one (e.g. only Channel[5]), load as elements without text.
+     * Leading whitespace is written as character references and an empty value as an empty CDATA section,
+     * which kStreaming, kMapped, kLazy and kCached read back. kDOM (TXMLEngine) decodes neither, so with kDOM
+     * only values without leading whitespace and not empty load back unchanged.
+     * 
+     * @param rootName name of the root node, which is not part of any path
+     * @return std::string xml document
+     */
+    std::string xml( std::string_view rootName = "config" ) const {
+        const TXmlConfigStore &nodes = structure();
+        std::string out;
+        out.reserve( nodes.allocatedBytes() );
+        out += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+        writeXml( nodes, 0, rootName, 0, out );
+        out += '\n';
+        return out;
+    }
+
+    /**
+     * @brief Write the config as an xml document, see xml()
+     * The document is written to a temporary file and renamed, so readers never see a partial file
+     * 
+     * @param filename file to write
+     * @param rootName name of the root node
+     * @return true on success
+     */
+    bool save( std::string filename, std::string_view rootName = "config" ) const {
+        return writeFile( filename, xml( rootName ) );
+    }
+
+    /**
+     * @brief Write the mapped config as a binary snapshot, see loadBinary
+     * 
+     * @param filename file to write
+     * @return true on success
+     */
+    bool saveBinary( std::string filename ) const {
+        const std::string data = structure().snapshot();
+        if ( data.empty() )
+            return false;
+        return writeFile( filename, data );
+    }
+
+    /**
+     * @brief Load a binary snapshot written by saveBinary
+     * The snapshot is memory mapped and used in place, so loading costs no parsing and no value copies
+     * 
+     * @param filename snapshot to load
+     * @return true on success, false if the file is missing, from another version or corrupt
+     */
+    bool loadBinary( std::string filename ) {
+        clearNodes();
+
+        auto file = std::make_shared<const TXmlConfigMappedFile>( filename );
+        if ( !file->isOpen() || !mNodes.restore( file->data(), file ) ) {
+            mNodes.clear();
+            mErrorParsing = true;
+            return false;
+        }
+        mTypedCache.invalidate( 0, mNodes.size() );
+        mAccessStats.resize( mNodes.size() );
+        return true;
+    }
+
+    /**
+     * @brief Main setup routine
+     * Loads the given XML file (or string) and maps it
+     * @param filename filename (or xml string) to load. If file the content is loaded as an xml doc
+     * @param asString false: filename is loaded and contents treated as xml doc, true: treat the string `filename` directly as an xml doc
+     * @param mode kDOM: parse via TXMLEngine, kStreaming: map in a single pass without building a DOM,
+     *             kMapped: map in a single pass from a memory mapped file without copying values,
+     *             kCached: use (or create) the binary snapshot filename + ".bin" when it is newer than the file,
+     *             kLazy: only skim the top level nodes, each one is mapped the first time a path inside it is read
+     * Files ending in .gz or .zst are decompressed while reading, URLs (root://, https://, ...) are read through TFile,
+     * when built with TXMLCONFIG_WITH_ZLIB, TXMLCONFIG_WITH_ZSTD and TXMLCONFIG_WITH_TFILE respectively.
+     * Both are loaded from a snapshot in cacheDirectory when one is set and fresh, kMapped and kCached act as kStreaming for them.
+     */
+    void load( std::string filename, bool asString = false, LoadMode mode = kDOM ) {
+        // empty the store of mNodes
+        clearNodes();
+        parse( filename, asString, mode );
+        // room for the new nodes in the typed cache and access stats
+        mTypedCache.invalidate( 0, mNodes.size() );
+        mAccessStats.resize( mNodes.size() );
+    }
+
+    /**
+     * @brief whether the last load failed
+     */
+    bool errorParsing() const { return mErrorParsing; }
+
+    /**
+     * @brief Load several files, and the fragments they include, into one config
+     * Files are parsed concurrently and merged in a fixed order: each file overrides the ones listed before it,
+     * and a file overrides the fragments it includes with <include file="..."/> directly below its root node.
+     * Include paths are relative to the including file, each file is merged once even if included repeatedly.
+     * 
+     * @param filenames files to load, later ones take precedence
+     * @param mode load mode used for every file, see load
+     * @param threads number of parser threads, 0 to use the hardware concurrency
+     * @return true on success, false (and an empty config) if any file fails to parse
+     */
+    bool loadFiles( const std::vector<std::string> &filenames, LoadMode mode = kDOM, unsigned threads = 0 ) {
+        using namespace std;
+        clearNodes();
+
+        struct Fragment {
+            string filename;
+            TXmlConfig cfg;
+            vector<size_t> includes;
+        };
+        vector<unique_ptr<Fragment>> fragments;
+        unordered_map<string, size_t> known;
+        auto add = [&]( const filesystem::path &file ) {
+            error_code ec;
+            filesystem::path id = filesystem::weakly_canonical( file, ec );
+            const string key = ( ec ? file : id ).string();
+            auto it = known.find( key );
+            if ( it != known.end() )
+                return it->second;
+            fragments.emplace_back( new Fragment() );
+            fragments.back()->filename = file.string();
+            return known[ key ] = fragments.size() - 1;
+        };
+
+        vector<size_t> roots, wave;
+        for ( const string &f : filenames ) {
+            const size_t before = fragments.size();
+            roots.push_back( add( f ) );
+            if ( roots.back() == before )
+                wave.push_back( roots.back() );
+        }
+
+        // parse in waves: the listed files, then the fragments they include, and so on
+        while ( !wave.empty() ) {
+            parallelFor( wave.size(), threads, [&]( size_t i ) {
+                Fragment &f = *fragments[ wave[ i ] ];
+                f.cfg.load( f.filename, false, mode );
+            } );
+
+            vector<size_t> next;
+            for ( size_t w : wave ) {
+                if ( fragments[ w ]->cfg.mErrorParsing ) {
+                    clearNodes();
+                    mErrorParsing = true;
+                    return false;
+                }
+                const filesystem::path dir = filesystem::path( fragments[ w ]->filename ).parent_path();
+                for ( uint32_t k = 0;; k++ ) {
+                    string_view inc;
+                    if ( !fragments[ w ]->cfg.find( "include" + ( k ? "[" + to_string( k ) + "]" : string() ) + ":file", inc ) )
+                        break;
+                    const size_t before = fragments.size();
+                    const size_t id = add( dir / inc );
+                    fragments[ w ]->includes.push_back( id );
+                    if ( id == before )
+                        next.push_back( id );
+                }
+            }
+            wave.swap( next );
+        }
+
+        // merge depth first, included fragments before the file including them
+        vector<char> state( fragments.size(), 0 ); // 0: pending, 1: in progress (include cycle), 2: merged
+        function<void( size_t )> merge = [&]( size_t i ) {
+            if ( state[ i ] )
+                return;
+            state[ i ] = 1;
+            for ( size_t inc : fragments[ i ]->includes )
+                merge( inc );
+            mNodes.merge( fragments[ i ]->cfg.structure() );
+            state[ i ] = 2;
+        };
+        for ( size_t r : roots )
+            merge( r );
+
+        mTypedCache.invalidate( 0, mNodes.size() );
+        mAccessStats.resize( mNodes.size() );
+        return true;
+    }
+protected:
+
+    /**
+     * @brief write data to a temporary file and rename it to filename, so concurrent jobs never see a partial file
+     * The temporary name holds the process id and a per-process count, so writers sharing a cache directory,
+     * forked jobs included, never write to the same temporary file
+     */
+    bool writeFile( const std::string &filename, const std::string &data ) const {
+        static std::atomic<uint64_t> written( 0 );
+#ifdef TXMLCONFIG_HAS_MMAP
+        const uint64_t pid = static_cast<uint64_t>( getpid() );
+#else
+        static const uint64_t pid = std::random_device()(); // no fork() here, a per-process token will do
+#endif
+        const std::string tmp = filename + ".tmp" + std::to_string( pid ) + "-" + std::to_string( written++ );
+        {
+            std::ofstream out( tmp, std::ios::binary | std::ios::trunc );
+            out.write( data.data(), data.size() );
+            if ( !out ) {
+                out.close();
+                std::remove( tmp.c_str() );
+                return false;
+            }
+        }
+        if ( 0 != std::rename( tmp.c_str(), filename.c_str() ) ) {
+            std::remove( tmp.c_str() );
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief append text with the xml special characters escaped, quotes too for attribute values
+     */
+    static void appendEscaped( std::string_view text, bool attribute, std::string &out ) {
+        size_t done = 0;
+        for ( size_t i = 0; i < text.size(); i++ ) {
+            const char *entity = nullptr;
+            switch ( text[ i ] ) {
+                case '&': entity = "&amp;"; break;
+                case '<': entity = "&lt;"; break;
+                case '>': entity = "&gt;"; break;
+                case '"': entity = attribute ? "&quot;" : nullptr; break;
+                default: break;
+            }
+            if ( entity == nullptr )
+                continue;
+            out.append( text.data() + done, i - done );
+            out += entity;
+            done = i + 1;
+        }
+        out.append( text.data() + done, text.size() - done );
+    }
+
+    /**
+     * @brief append the text of an element so that loading gives it back unchanged
+     * Leading whitespace is not content on load, so it is written as character references,
+     * and an element without text loads as valDNE, so an empty value is an empty CDATA section
+     */
+    static void appendContent( std::string_view text, std::string &out ) {
+        if ( text.empty() ) {
+            out += "<![CDATA[]]>";
+            return;
+        }
+        size_t lead = 0;
+        for ( ; lead < text.size() && std::isspace( static_cast<unsigned char>( text[ lead ] ) ); lead++ )
+            out.append( "&#" ).append( toChars( static_cast<int>( text[ lead ] ) ) ).append( ";" );
+        appendEscaped( text.substr( lead ), false, out );
+    }
+
+    /**
+     * @brief append node id and its subtree as xml, see xml()
+     * The content goes right after the start tag and before the first child, since the first text decides it on load
+     */
+    void writeXml( const TXmlConfigStore &nodes, uint32_t id, std::string_view name, size_t depth, std::string &out ) const {
+        const TXmlConfigStore::Node &n = nodes.node( id );
+        out.append( 2 * depth, ' ' );
+        out += '<';
+        out += name;
+        bool hasChildren = false;
+        for ( uint32_t c = n.firstChild; c != TXmlConfigStore::npos; c = nodes.node( c ).nextSibling ) {
+            if ( !nodes.isAttribute( c ) ) {
+                hasChildren = true;
+                continue;
+            }
+            const TXmlConfigStore::Node &a = nodes.node( c );
+            out += ' ';
+            out.append( a.seg + 1, a.segLen - 1 );
+            out += "=\"";
+            if ( a.val != nullptr && TXmlConfigStore::value( a ) != TXmlConfig::valDNE )
+                appendEscaped( TXmlConfigStore::value( a ), true, out );
+            out += '"';
+        }
+
+        // an empty value is content too, only elements without text hold valDNE
+        const bool hasContent = n.val != nullptr && TXmlConfigStore::value( n ) != TXmlConfig::valDNE && ( n.valLen > 0 || id > 0 );
+        if ( !hasContent && !hasChildren ) {
+            out += "/>";
+            return;
+        }
+        out += '>';
+        if ( hasContent )
+            appendContent( TXmlConfigStore::value( n ), out );
+
+        // repeated siblings in index order: the k-th element named X in the child list is written as the X
+        // with the k-th smallest index, so set( "Ch[1]" ) before set( "Ch" ) loads back the same. Indices
+        // missing below a written one become empty elements, so a lone Ch[5] keeps its index.
+        struct Repeated {
+            std::vector<uint32_t> ids;
+            size_t next = 0;
+            uint32_t written = 0; // indices written so far
+        };
+        std::unordered_map<std::string_view, Repeated> repeated;
+        for ( uint32_t c = n.firstChild; c != TXmlConfigStore::npos; c = nodes.node( c ).nextSibling )
+            if ( !nodes.isAttribute( c ) )
+                repeated[ std::string_view( nodes.node( c ).seg, nodes.node( c ).segLen ) ].ids.push_back( c );
+        for ( auto &r : repeated ) {
+            auto byIndex = [&]( uint32_t a, uint32_t b ) { return nodes.node( a ).index < nodes.node( b ).index; };
+            if ( !std::is_sorted( r.second.ids.begin(), r.second.ids.end(), byIndex ) )
+                std::stable_sort( r.second.ids.begin(), r.second.ids.end(), byIndex );
+        }
+
+        bool first = true;
+        auto startChild = [&]() -> size_t {
+            // the first child goes right after the content, the first text decides the content on load
+            const bool sameLine = first && hasContent;
+            first = false;
+            if ( !sameLine )
+                out += '\n';
+            return sameLine ? 0 : depth + 1;
+        };
+        for ( uint32_t c = n.firstChild; c != TXmlConfigStore::npos; c = nodes.node( c ).nextSibling ) {
+            if ( nodes.isAttribute( c ) )
+                continue;
+            const std::string_view seg( nodes.node( c ).seg, nodes.node( c ).segLen );
+            Repeated &r = repeated[ seg ];
+            const uint32_t e = r.ids[ r.next++ ];
+            const std::string_view childName = ( !seg.empty() && seg[0] == '.' ) ? seg.substr( 1 ) : seg;
+            for ( ; r.written < nodes.node( e ).index; r.written++ ) {
+                out.append( 2 * startChild(), ' ' );
+                out.append( "<" ).append( childName.data(), childName.size() ).append( "/>" );
+            }
+            writeXml( nodes, e, childName, startChild(), out );
+            r.written = nodes.node( e ).index + 1;
+        }
+        if ( hasChildren ) {
+            out += '\n';
+            out.append( 2 * depth, ' ' );
+        }
+        out += "</";
+        out += name;
+        out += '>';
+    }
+
+    /**
+     * @brief run f(0) ... f(n-1) on up to threads worker threads, 0 for the hardware concurrency
+     */
+    template <typename F>
+    static void parallelFor( size_t n, unsigned threads, F f ) {
+        if ( threads == 0 )
+            threads = std::max( 1u, std::thread::hardware_concurrency() );
+        threads = static_cast<unsigned>( std::min<size_t>( threads, n ) );
+        std::atomic<size_t> nextItem( 0 );
+        auto work = [&]() {
+            for ( size_t i = nextItem++; i < n; i = nextItem++ )
+                f( i );
+        };
+        std::vector<std::thread> pool;
+        for ( unsigned t = 1; t < threads; t++ )
+            pool.emplace_back( work );
+        work();
+        for ( std::thread &t : pool )
+            t.join();
+    }
+
+    /**
+     * @brief empty the store and everything derived from it
+     */
+    void clearNodes() {
+        mNodes.clear();
+        mTypedCache.reset();
+        mAccessStats.clear();
+        mFlat.reset();
+        mLazy.reset();
+        mGeneration = nextGeneration();
+        mErrorParsing = false;
+    }
+
+    /**
+     * @brief load a remote or compressed source through the snapshot cache in cacheDirectory, see load
+     * "<hash of name>.ref" names the snapshot of the last fetch, which is "<checksum of the document>.bin":
+     * identical documents share one snapshot, however many names they are fetched under.
+     */
+    void parseSource( const std::string &name, LoadMode mode ) {
+        using namespace std;
+        const bool remote = TXmlConfigSource::isRemote( name );
+        char hex[ 17 ];
+        string ref, stamp;
+        if ( !cacheDirectory.empty() ) {
+            snprintf( hex, sizeof( hex ), "%016llx", static_cast<unsigned long long>( TXmlConfigStore::hashKey( name ) ) );
+            ref = cacheDirectory + "/" + hex + ".ref";
+            error_code ec1, ec2;
+            if ( !remote ) {
+                // a local file is fresh while its size and modification time are unchanged
+                const auto size = filesystem::file_size( name, ec1 );
+                const auto time = filesystem::last_write_time( name, ec2 );
+                if ( !ec1 && !ec2 )
+                    stamp = to_string( size ) + " " + to_string( time.time_since_epoch().count() );
+            }
+
+            string entry;
+            if ( readFile( ref, entry ) ) {
+                const size_t sp = entry.find( ' ' );
+                const auto refTime = filesystem::last_write_time( ref, ec1 );
+                const bool fresh = remote ? !ec1 && filesystem::file_time_type::clock::now() - refTime < chrono::seconds( cacheMaxAge )
+                                          : !stamp.empty() && sp != string::npos && entry.compare( sp + 1, string::npos, stamp ) == 0;
+                if ( fresh && loadBinary( cacheDirectory + "/" + entry.substr( 0, sp ) + TXmlConfig::binaryExt ) )
+                    return;
+                clearNodes();
+            }
+        }
+
+        string content;
+        if ( !TXmlConfigSource::fetch( name, content ) ) {
+            mErrorParsing = true;
+            return;
+        }
+        parse( content, true, mode );
+        if ( mErrorParsing || ref.empty() )
+            return;
+
+        // best effort, e.g. the directory may be read only
+        snprintf( hex, sizeof( hex ), "%016llx", static_cast<unsigned long long>( TXmlConfigStore::checksum( content.data(), content.size() ) ) );
+        const string snapshot = cacheDirectory + "/" + hex + TXmlConfig::binaryExt;
+        error_code ec;
+        filesystem::create_directories( cacheDirectory, ec );
+        if ( filesystem::exists( snapshot, ec ) || saveBinary( snapshot ) )
+            writeFile( ref, string( hex ) + " " + stamp );
+    }
+
+    /**
+     * @brief parse a document into the (empty) store, see load
+     */
+    void parse( const std::string &filename, bool asString, LoadMode mode ) {
+        using namespace std;
+
+        if ( !asString && ( TXmlConfigSource::isRemote( filename ) || TXmlConfigSource::isCompressed( filename ) ) ) {
+            parseSource( filename, mode );
+            return;
+        }
+
+        if ( mode == kCached && !asString ) {
+            const string snapshot = filename + TXmlConfig::binaryExt;
+            error_code ec1, ec2;
+            const auto snapshotTime = filesystem::last_write_time( snapshot, ec1 );
+            const auto sourceTime = filesystem::last_write_time( filename, ec2 );
+            if ( !ec1 && !ec2 && snapshotTime >= sourceTime && loadBinary( snapshot ) )
+                return;
+            load( filename, false, kMapped );
+            if ( !mErrorParsing )
+                saveBinary( snapshot ); // best effort, e.g. the directory may be read only
+            return;
+        }
+
+        if ( mode == kLazy ) {
+            bool ok = false;
+            if ( asString ) {
+                auto doc = make_shared<const string>( filename );
+                ok = skim( *doc, doc );
+            } else {
+                auto file = make_shared<const TXmlConfigMappedFile>( filename );
+                ok = file->isOpen() && skim( file->data(), file );
+            }
+            if ( !ok ) {
+                mNodes.clear();
+                mLazy.reset();
+                mErrorParsing = true;
+            }
+            return;
+        }
+
+        if ( mode == kMapped && !asString ) {
+            auto file = make_shared<const TXmlConfigMappedFile>( filename );
+            if ( file->isOpen() && mapStream( file->data(), true ) ) {
+                mNodes.keepAlive( file );
+            } else {
+                mNodes.clear();
+                mErrorParsing = true;
+            }
+            return;
+        }
+
+        if ( mode != kDOM ) {
+            string content;
+            if ( !( asString ? mapStream( filename ) : ( readFile( filename, content ) && mapStream( content ) ) ) ) {
+                mNodes.clear(); // no partial configs
+                mErrorParsing = true;
+            }
+            return;
+        }
+
+        // Create XML engine for parsing file
+        TXMLEngine xml;
+
+        // Now try to parse xml file
+        XMLDocPointer_t xmldoc;
+        if (asString)
+            xmldoc = xml.ParseString(filename.c_str());
+        else
+            xmldoc = xml.ParseFile(filename.c_str());
+
+        if (!xmldoc) { // parse failed, TODO inform of error
+            mErrorParsing = true;
+            return;
+        }
+
+        // access to root node (should be "config")
+        XMLNodePointer_t root_node = xml.DocGetRootElement(xmldoc);
+        // build the file map for config access
+        MapScratch scratch;
+        mapFile(xml, root_node, 1, scratch);
+
+        // Release memory before finishing
+        xml.FreeDoc(xmldoc);
+    }
+};
+
+// Forward declare the templates, otherwise undefined behavior in Release builds
+template <>
+std::string TXmlConfig::convert( std::string str ) const;
+template <>
+bool TXmlConfig::convert( std::string str ) const;
+template <>
+TString TXmlConfig::convert(std::string str) const;
+template <>
+std::string TXmlConfig::get( std::string path, std::string dv ) const;
+template <>
+std::string_view TXmlConfig::get( std::string path, std::string_view dv ) const;
+template <>
+void TXmlConfig::set( std::string path, std::string v );
+template <>
+void TXmlConfig::set( std::string path, bool bv );
 
-    bool mErrorParsing = false;
-    // read only map of the config, read with get<> functions
-    std::map<std::string, std::string> mNodes;
-    static std::stringstream sstr; // reused for string to numeric conversion
+/**
+ * @brief A config file that can be reloaded while other threads read it
+ * Every reload publishes a new immutable TXmlConfig, readers keep the version they hold until they ask again
+ * 
+ * @code
+ * TXmlConfigLive live( "thresholds.xml" );
+ * live.onChange( "Thresholds", []( const TXmlConfig::Change &c ) { std::cout << c.path << " = " << c.newValue << std::endl; } );
+ * ...
+ * live.reload(); // periodically, no-op unless the file changed
+ * auto cfg = live.config(); // consistent view for the rest of this event
+ * @endcode
+ */
+class TXmlConfigLive {
+public:
+    typedef std::function<void( const TXmlConfig::Change & )> Callback;
 
     /**
-     * @brief get lowest non-existing path index
-     * assumes bare path and adds [i] until DNE
-     * starts at 1 since 0 is checked on existance
-     * @param path base path to check
-     * @return size_t index, starts at 1
+     * @brief Load filename and start watching it, check config()->errorParsing() for the first load
+     * 
+     * @param filename file to load and watch
+     * @param mode load mode, kMapped and kCached load from memory like kStreaming (the file may be rewritten under us)
      */
-    size_t pathCount( const std::string path ){
-        size_t index = 1;
-        std::string p = path + TString::Format( "[%zu]", index ).Data();
-        while ( mNodes.count( p ) ){
-            index ++;
-            p = path + TString::Format( "[%zu]", index ).Data();
-        }
-        return index;
+    TXmlConfigLive( std::string filename, TXmlConfig::LoadMode mode = TXmlConfig::kDOM )
+        : mFilename( filename ), mMode( mode == TXmlConfig::kDOM ? TXmlConfig::kDOM : TXmlConfig::kStreaming ),
+          mConfig( std::make_shared<const TXmlConfig>() ) {
+        reload();
     }
 
     /**
-     * @brief Reads an xml document and writes it into map
-     * 
-     * @param xml xml document to map
-     * @param node starting node - allows recursive mapping
-     * @param level the integer index of the level of current parsing
-     * @param path the path for the current node
+     * @brief The current config, safe to call from any thread
+     * The returned config never changes, hold on to it for a consistent view
      */
-    void mapFile(TXMLEngine &xml, XMLNodePointer_t node, Int_t level, std::string path = "") {
-        using namespace std;
-        // add the path delimeter above top level
-        if ( !path.empty() ) path += TXmlConfig::pathDelim;
-
-        // we skip the root node to maintain consistency with original XmlConfig
-        if ( level > 1)
-            path += xml.GetNodeName(node);
-
-        // get the node name and content if it exists
-        const string node_name = xml.GetNodeName(node);
-        const string node_content = xml.GetNodeContent(node) != nullptr ? xml.GetNodeContent(node) : TXmlConfig::valDNE;
-
-        // be careful about repeated nodes
-        if ( mNodes.count( path ) == 0 ) {
-            mNodes[ path ] = node_content;
-        } else { // add an array index if more than one
-            size_t index = pathCount( path );
-            path += TString::Format( "[%zu]", index ).Data();
-            mNodes[ path ] = node_content;
-        }
+    std::shared_ptr<const TXmlConfig> config() const {
+        return std::atomic_load( &mConfig );
+    }
 
-        // loop through attributes of this node
-        XMLAttrPointer_t attr = xml.GetFirstAttr(node);
-        while (attr != 0) {
+    /**
+     * @brief Call callback from reload() for every changed entry at prefix or below it
+     * 
+     * @param prefix path of the node to watch, "" for all entries
+     * @param callback called with each change, after the new config is published
+     */
+    void onChange( std::string prefix, Callback callback ) {
+        std::lock_guard<std::mutex> lock( mMutex );
+        TXmlConfig::canonize( prefix );
+        mCallbacks.emplace_back( prefix, callback );
+    }
 
-            // get the attribute name and value if exists
-            const string attr_name = xml.GetAttrName(attr);
-            const string attr_val = xml.GetAttrValue(attr) != nullptr ? xml.GetAttrValue(attr) : TXmlConfig::valDNE;
-            
-            // save attributes with the attribute delim ":" 
-            mNodes[ (path + TXmlConfig::attrDelim + attr_name) ] = attr_val;
-            attr = xml.GetNextAttr(attr);
-        }
+    /**
+     * @brief Apply a batch of writes to a copy of the current config and publish it atomically
+     * Callbacks see the entries the batch changed. The next reload() of an edited file replaces these writes.
+     * 
+     * @param batch writes to apply
+     */
+    void update( const TXmlConfig::Batch &batch ) {
+        std::lock_guard<std::mutex> lock( mMutex );
+        std::shared_ptr<const TXmlConfig> previous = config();
+        auto next = std::make_shared<TXmlConfig>( *previous );
+        next->update( batch );
+        std::atomic_store( &mConfig, std::shared_ptr<const TXmlConfig>( next ) );
 
-        // recursively get child nodes
-        XMLNodePointer_t child = xml.GetChild(node);
-        while (child != 0) {
-            mapFile(xml, child, level + 1, path);
-            child = xml.GetNext(child);
+        if ( mCallbacks.empty() )
+            return;
+        // only the last write to a path counts, reported in batch order
+        std::unordered_set<std::string_view> seen;
+        std::vector<TXmlConfig::Change> changes;
+        for ( auto it = batch.entries().rbegin(); it != batch.entries().rend(); ++it ) {
+            if ( !seen.insert( it->first ).second )
+                continue;
+            TXmlConfig::Change c;
+            c.path = it->first;
+            c.newValue = it->second;
+            c.kind = previous->exists( c.path ) ? TXmlConfig::Change::kModified : TXmlConfig::Change::kAdded;
+            if ( c.kind == TXmlConfig::Change::kModified ) {
+                c.oldValue = previous->get<std::string>( c.path, "" );
+                if ( c.oldValue == c.newValue )
+                    continue;
+            }
+            changes.push_back( c );
         }
-    } // mapFile
-public:
+        for ( auto c = changes.rbegin(); c != changes.rend(); ++c )
+            for ( auto &cb : mCallbacks )
+                if ( watches( cb.first, c->path ) )
+                    cb.second( *c );
+    }
 
     /**
-     * @brief Returns a path in its cannonical form
+     * @brief Re-read the file if its modification time, size or content changed, and publish it
+     * Unchanged files cost a stat, touched but identical files a read and a checksum
      * 
-     * @param path Path to cannoize, returned in place by reference
+     * @return true if a new config was published, false if nothing changed or the new file failed to parse.
+     * Until a first load succeeds, a missing, unreadable or malformed file publishes an empty config with errorParsing() set
      */
-    static void canonize( std::string &path ) {
-        // remove whitespace
-        path.erase(std::remove_if(path.begin(), path.end(), static_cast<int(*) (int)>(std::isspace)), path.end());
+    bool reload() {
+        std::lock_guard<std::mutex> lock( mMutex );
+        std::error_code ec1, ec2;
+        const auto mtime = std::filesystem::last_write_time( mFilename, ec1 );
+        const auto size = std::filesystem::file_size( mFilename, ec2 );
+        if ( ec1 || ec2 )
+            return failed( nullptr );
+        if ( mLoaded && mtime == mTime && size == mSize )
+            return false;
 
-        // removes "[0]" found in paths, so that the first element in a list can be accessed by index 0 or bare path
-        size_t pos = path.find( "[0]" );
+        std::ifstream in( mFilename, std::ios::binary );
+        std::string content( size, '\0' );
+        if ( !in.read( &content[0], size ) )
+            return failed( nullptr );
+        const uint64_t sum = TXmlConfigStore::checksum( content.data(), content.size() );
+        mTime = mtime;
+        mSize = size;
+        if ( mLoaded && sum == mChecksum )
+            return false;
 
-        // branchless version using ternary op
-        size_t len = (pos != std::string::npos) ? 3 : 0;
-        pos = (pos != std::string::npos) ? pos : 0;
-        path.erase( pos, len ); // does nothing if "[0]" not found
-        return;
+        auto next = std::make_shared<TXmlConfig>();
+        next->load( content, true, mMode );
+        if ( next->errorParsing() )
+            return failed( next ); // keep serving the last good config
+        mChecksum = sum;
+        mLoaded = true;
+
+        std::shared_ptr<const TXmlConfig> previous = config();
+        std::atomic_store( &mConfig, std::shared_ptr<const TXmlConfig>( next ) );
+
+        if ( !mCallbacks.empty() ) {
+            for ( const TXmlConfig::Change &c : previous->diff( *next ) ) {
+                for ( auto &cb : mCallbacks )
+                    if ( watches( cb.first, c.path ) )
+                        cb.second( c );
+            }
+        }
+        return true;
     }
 
+protected:
     /**
-     * @brief dump config to a basic string representation - mostly for debugging
+     * @brief a reload failed: before the first good load publish the failure, so config()->errorParsing() reports it
      * 
-     * @return std::string 
+     * @param next the config that failed to parse, nullptr if the file could not be read
+     * @return false, nothing new is published once a good config is in place
      */
-    std::string dump() const {
-        using namespace std;
-        TXmlConfig::sstr.str("");
-        TXmlConfig::sstr.clear();
-        for ( auto kv : mNodes ){
-            if ( kv.second == TXmlConfig::valDNE ) continue;
-            TXmlConfig::sstr << "[" << kv.first << "] = " << kv.second << endl;
+    bool failed( std::shared_ptr<TXmlConfig> next ) {
+        if ( mLoaded )
+            return false;
+        if ( !next ) {
+            next = std::make_shared<TXmlConfig>();
+            next->mErrorParsing = true;
         }
-        return TXmlConfig::sstr.str();
+        std::atomic_store( &mConfig, std::shared_ptr<const TXmlConfig>( next ) );
+        return false;
     }
 
     /**
-     * @brief returns whether or not a path exist
-     * Either node or attribute - used to determine if default value is used
-     * 
-     * @param path - the path to check
-     * @return true : path exists
-     * @return false : path DNE
+     * @brief whether path is prefix or below it, "Thresholds" covers "Thresholds[2]:max" but not "ThresholdsX"
      */
-    bool exists( std::string path ) const {
-        TXmlConfig::canonize( path );
-        if ( 0 == mNodes.count( path ) )
+    static bool watches( std::string_view prefix, std::string_view path ) {
+        if ( path.compare( 0, prefix.size(), prefix ) != 0 )
             return false;
-        return true;
+        if ( prefix.empty() || path.size() == prefix.size() )
+            return true;
+        const char last = prefix.back(), next = path[ prefix.size() ];
+        return last == '.' || last == ':' || next == '.' || next == ':' || next == '[';
     }
 
+    std::string mFilename;
+    TXmlConfig::LoadMode mMode;
+    std::shared_ptr<const TXmlConfig> mConfig; // only accessed through atomic_load / atomic_store
+    std::mutex mMutex; // serializes reload(), update() and onChange()
+    std::vector<std::pair<std::string, Callback>> mCallbacks;
+    bool mLoaded = false;
+    std::filesystem::file_time_type mTime;
+    uintmax_t mSize = 0;
+    uint64_t mChecksum = 0;
+};
+
+/**
+ * @brief Binds the fields of a plain struct to config paths, to fill the whole struct in one call
+ * 
+ * @code
+ * struct TrackCuts { double ptMin; int nHitsMin; std::vector<int> sectors; };
+ * static const auto trackCuts = TXmlConfigSchema<TrackCuts>()
+ *     .bind( TXML_PATH( "Cuts.Track:ptMin" ), &TrackCuts::ptMin, 0.2 )
+ *     .bind( TXML_PATH( "Cuts.Track:nHitsMin" ), &TrackCuts::nHitsMin, 15 )
+ *     .bind( TXML_PATH( "Cuts.Track:sectors" ), &TrackCuts::sectors );
+ * TrackCuts cuts = trackCuts.read( cfg );
+ * @endcode
+ * 
+ * @tparam S struct to fill
+ */
+template <typename S>
+class TXmlConfigSchema {
+public:
     /**
-     * @brief Generic conversion of type T from string
-     * override this for special conversions
-     * 
-     * @tparam T : Type to convert to and return
-     * @param s : input string to use for conversion
-     * @return T converted value of type T
+     * @brief bind field to path, read with get<T>
      */
     template <typename T>
-    T convert( std::string s ) const {
-        T rv;
-        TXmlConfig::sstr.str("");
-        TXmlConfig::sstr.clear();
-        TXmlConfig::sstr << s;
-        TXmlConfig::sstr >> rv;
-        return rv;
+    TXmlConfigSchema &bind( TXmlConfigPath path, T S::*field, T dv = T() ) {
+        mFields.push_back( [=]( const TXmlConfig &cfg, S &s ) { s.*field = cfg.get<T>( path, dv ); } );
+        return *this;
     }
 
     /**
-     * @brief Generic conversion of type T to a string
-     * 
-     * @tparam T : type to convert
-     * @param v : value of type T
-     * @return std::string output string with representation of T
+     * @brief bind a vector field to path, read with getVector<T>
      */
     template <typename T>
-    std::string convertTo( T v ) const {
-        TXmlConfig::sstr.str("");
-        TXmlConfig::sstr.clear();
-        TXmlConfig::sstr << v;
-        return TXmlConfig::sstr.str();
+    TXmlConfigSchema &bind( TXmlConfigPath path, std::vector<T> S::*field, std::vector<T> dv = {} ) {
+        mFields.push_back( [=]( const TXmlConfig &cfg, S &s ) { s.*field = cfg.getVector<T>( path, dv ); } );
+        return *this;
     }
 
-
     /**
-     * @brief template function for getting any type that can be converted from string via stringstream
-     * 
-     * @tparam T type to return 
-     * @param path path to lookup
-     * @param dv default value to return if the node DNE
-     * @return T return value of type T
+     * @brief fill every bound field of s from cfg, defaults for paths that DNE
      */
-    template <typename T>
-    T get( std::string path, T dv ) const {
-    
-        // return default value if path DNE
-        if ( !exists( path ) )
-            return dv;
+    void read( const TXmlConfig &cfg, S &s ) const {
+        for ( const auto &f : mFields )
+            f( cfg, s );
+    }
 
-        TXmlConfig::canonize( path );
-        // convrt from string to type T and return
-        return convert<T>( mNodes.at( path ) );
+    S read( const TXmlConfig &cfg ) const {
+        S s{};
+        read( cfg, s );
+        return s;
     }
 
+protected:
+    std::vector<std::function<void( const TXmlConfig &, S & )>> mFields;
+};
+
+/**
+ * @brief Checks types, ranges, required paths and list lengths of a config in one pass after load()
+ * Build it once, e.g. as a static, then run it on every config loaded. Rules take a path or a query() pattern.
+ * 
+ * @code
+ * static const auto validator = TXmlConfigValidator()
+ *     .require<int>( "Cuts.Track:nHitsMin" ).range( 0, 100 )
+ *     .optional<double>( "Sector[*].Module[*]:gain" ).range( 0.5, 2.0 )
+ *     .require<std::vector<float>>( "Calib:weights" ).length( 16 );
+ * cfg.enableTypedCache();
+ * cfg.load( "run.xml" );
+ * for ( const auto &issue : validator.validate( cfg ) )
+ *     std::cerr << issue.path << ": " << issue.message << std::endl;
+ * @endcode
+ * 
+ * With the typed cache enabled, every value that passes is stored in it already converted,
+ * so the later get<T> / getVector<T> of validated paths never parse (plain configs only, not overlays or kLazy).
+ */
+class TXmlConfigValidator {
+public:
+    struct Issue {
+        std::string path;    // the offending path, or the rule pattern for a missing required path
+        std::string message;
+    };
+
     /**
-     * @brief Writes a value of type T to the map
-     * Uses convertTo<T> to convert type T to a string rep 
-     * @tparam T type of value to write
-     * @param path path to write to
-     * @param v value of type T
+     * @brief path (or every node matching the pattern) must exist and convert to T
+     * T is an arithmetic type, std::string or std::vector of those
      */
     template <typename T>
-    void set( std::string path, T v ) {
-        TXmlConfig::canonize( path );
-        // convrt from string to type T and return
-        mNodes[ path ] = convertTo<T>( v );
+    TXmlConfigValidator &require( std::string pattern ) {
+        return add<T>( std::move( pattern ), true );
     }
-    
+
     /**
-     * @brief Get a Vector object from config
-     * 
-     * @tparam T type of value for the vector object
-     * @param path path to lookup
-     * @param dv default value, can use initializer list
-     * @return std::vector<T> vector of type T returned
+     * @brief if path (or a node matching the pattern) exists it must convert to T
      */
     template <typename T>
-    std::vector<T> getVector( std::string path, std::vector<T> dv ) const {
-        if ( !exists( path ) )
-            return dv;
-        
-        TXmlConfig::canonize( path );
-        std::string val = mNodes.at( path );
-        // remove whitespace
-        val.erase(std::remove_if(val.begin(), val.end(), static_cast<int(*) (int)>(std::isspace) ), val.end());
-        std::vector<std::string> elems;
+    TXmlConfigValidator &optional( std::string pattern ) {
+        return add<T>( std::move( pattern ), false );
+    }
 
-        // split the string by commas
-        [&]() {
-            std::stringstream  ss(val);
-            std::string str;
-            while (std::getline(ss, str, ',')) {
-                elems.push_back(str);
-            }
-        }();
+    /**
+     * @brief the numbers of the last rule (each element for lists) must lie in [min, max]
+     */
+    TXmlConfigValidator &range( double min, double max ) {
+        mRules.back().min = min;
+        mRules.back().max = max;
+        return *this;
+    }
 
-        // for each element, convert to type T and push into vector
-        std::vector<T> result;
-        for ( auto sv : elems ){
-            result.push_back( convert<T>( sv ) );
-        }
-        return result;
+    /**
+     * @brief the list of the last rule must have between min and max elements
+     */
+    TXmlConfigValidator &length( size_t min, size_t max ) {
+        mRules.back().minLength = min;
+        mRules.back().maxLength = max;
+        return *this;
     }
 
+    TXmlConfigValidator &length( size_t n ) { return length( n, n ); }
+
     /**
-     * @brief list the paths of children nodes for a given node
+     * @brief check every rule against cfg
      * 
-     * @param path path to search for children
-     * @return std::vector<std::string> list of full paths to the children nodes
+     * @param cfg config to check
+     * @param threads threads checking the matched values, 0 for one per core on large configs
+     * @return std::vector<Issue> problems found in rule order, empty if cfg is valid
      */
-    std::vector<std::string> childrenOf( std::string path ) const {
-        using namespace std;
-        vector<string> result;
+    std::vector<Issue> validate( const TXmlConfig &cfg, unsigned threads = 0 ) const {
+        struct Item {
+            const Rule *rule;
+            TXmlConfig::NodeRef node;
+        };
+        std::vector<Issue> issues;
+        std::vector<Item> items;
+        for ( const Rule &r : mRules ) {
+            bool found = false;
+            for ( const TXmlConfig::NodeRef &n : cfg.query( r.pattern ) ) {
+                if ( !n.exists() )
+                    continue;
+                items.push_back( { &r, n } );
+                found = true;
+            }
+            if ( r.required && !found )
+                issues.push_back( { r.pattern, "required but missing" } );
+        }
 
-        canonize(path);
+        // node ids of plain configs are their typed cache keys
+        const bool warm = cfg.mTypedCache.enabled() && !cfg.mParent && !cfg.mLazy;
+        std::vector<std::string> messages( items.size() );
+        if ( threads == 0 && items.size() < parallelThreshold )
+            threads = 1;
+        TXmlConfig::parallelFor( items.size(), threads, [&]( size_t i ) {
+            const Item &it = items[ i ];
+            messages[ i ] = it.rule->check( *it.rule, cfg, it.node, warm );
+        } );
+        for ( size_t i = 0; i < items.size(); i++ )
+            if ( !messages[ i ].empty() )
+                issues.push_back( { items[ i ].node.path(), messages[ i ] } );
+        return issues;
+    }
 
-        // test a path to see if it is an attribute
-        auto is_attribute = [&](string str){
-            return ( str.find( TXmlConfig::attrDelim ) != string::npos );
-        };
+protected:
+    static constexpr size_t parallelThreshold = 4096;
 
-        for ( auto kv : mNodes ){
-            // get the first n characters of this path
-            string parent = (kv.first).substr( 0, path.length() );
+    struct Rule;
+    // returns "" if the value is valid
+    using Check = std::string ( * )( const Rule &, const TXmlConfig &, const TXmlConfig::NodeRef &, bool warm );
 
-            // dont add self as a child
-            if ( parent == kv.first ) continue;
+    struct Rule {
+        std::string pattern;
+        bool required = false;
+        double min = -std::numeric_limits<double>::infinity();
+        double max = std::numeric_limits<double>::infinity();
+        size_t minLength = 0;
+        size_t maxLength = std::numeric_limits<size_t>::max();
+        Check check = nullptr;
+    };
 
-            // if parent path matches query path then it is a child.
-            if ( parent == path && !is_attribute( kv.first )){
-                result.push_back( kv.first );
-            }
-        } // loop over all nodes
+    template <typename T>
+    struct IsVector : std::false_type {};
+    template <typename T>
+    struct IsVector<std::vector<T>> : std::true_type { using Element = T; };
 
-        return result;
+    template <typename T>
+    TXmlConfigValidator &add( std::string pattern, bool required ) {
+        Rule r;
+        r.pattern = std::move( pattern );
+        r.required = required;
+        r.check = &checkValue<T>;
+        mRules.push_back( std::move( r ) );
+        return *this;
     }
 
     /**
-     * @brief Constructor is noop, use load(...)
-     * 
+     * @brief convert one element to T, the message says why it does not
      */
-    TXmlConfig() {}
+    template <typename T>
+    static bool element( const Rule &r, std::string_view elem, T &v, std::string &message ) {
+        if constexpr ( std::is_same<T, bool>::value ) {
+            long long i = 0;
+            if ( elem == "true" || elem == "false" ) {
+                v = elem == "true";
+                return true;
+            }
+            if ( !TXmlConfig::fromChars( elem, i, true ) ) {
+                message = "'" + std::string( elem ) + "' is not a bool";
+                return false;
+            }
+            v = i != 0;
+            return true;
+        } else if constexpr ( std::is_arithmetic<T>::value ) {
+            if ( !TXmlConfig::fromChars( elem, v, true ) ) {
+                message = "'" + std::string( elem ) + "' is not " + ( std::is_integral<T>::value ? "an integer" : "a number" ) + " of the type";
+                return false;
+            }
+            if ( static_cast<double>( v ) < r.min || static_cast<double>( v ) > r.max ) {
+                message = std::string( elem ) + " is outside [" + TXmlConfig::toChars( r.min ) + ", " + TXmlConfig::toChars( r.max ) + "]";
+                return false;
+            }
+            return true;
+        } else {
+            static_assert( std::is_same<T, std::string>::value, "TXmlConfigValidator: T must be arithmetic, std::string or a std::vector of those" );
+            v.assign( elem.data(), elem.size() );
+            return true;
+        }
+    }
 
-    /**
-     * @brief Construct a new Fwd Tracker Config object and load a file
-     * 
-     * @param filename 
-     */
-    TXmlConfig(std::string filename) {
-        load( filename );
+    template <typename T>
+    static std::string checkValue( const Rule &r, const TXmlConfig &cfg, const TXmlConfig::NodeRef &node, bool warm ) {
+        std::string message;
+        if constexpr ( IsVector<T>::value ) {
+            using E = typename IsVector<T>::Element;
+            T list;
+            bool ok = true;
+            TXmlConfig::splitList( node.value(), [&]( std::string_view elem ) {
+                E v{};
+                if ( ok && !( ok = element( r, elem, v, message ) ) )
+                    message = "element " + std::to_string( list.size() ) + ": " + message;
+                list.push_back( v );
+            } );
+            if ( !ok )
+                return message;
+            if ( list.size() < r.minLength || list.size() > r.maxLength )
+                return std::to_string( list.size() ) + " elements, expected " +
+                       ( r.minLength == r.maxLength ? std::to_string( r.minLength ) : std::to_string( r.minLength ) + " to " + std::to_string( r.maxLength ) );
+            if constexpr ( std::is_arithmetic<E>::value ) {
+                if ( warm )
+                    cfg.mTypedCache.get<T>( node.id(), [&]() { return list; } );
+            }
+        } else {
+            T v{};
+            if ( !element( r, node.value(), v, message ) )
+                return message;
+            if constexpr ( std::is_arithmetic<T>::value && !std::is_same<T, bool>::value ) {
+                if ( warm )
+                    cfg.mTypedCache.get<T>( node.id(), [&]() { return v; } );
+            }
+        }
+        return message;
     }
 
+    std::vector<Rule> mRules;
+};
+
+/**
+ * @brief Builds objects (histograms, cuts, ...) from every node of a subtree in one walk
+ * A maker is registered per node type: the "type" attribute of a node, or its name without one.
+ * Makers read the attributes through a Definition, which finds them without path lookups and parses
+ * each distinct list (e.g. bins-x="100, 0, 10") once per book() however many definitions share it.
+ * TXmlConfigHist.h registers the ROOT histogram classes.
+ * 
+ * @code
+ * TXmlConfigFactory<TCut> cuts;
+ * cuts.add( "Cut", []( const TXmlConfigFactory<TCut>::Definition &d ) {
+ *     return new TCut( std::string( d.attr( "name" ) ).c_str(), std::string( d.attr( "expr" ) ).c_str() );
+ * } );
+ * for ( auto &booked : cuts.book( cfg, "Cuts" ) )
+ *     std::cout << booked.first << " : " << booked.second->GetTitle() << std::endl;
+ * @endcode
+ * 
+ * @tparam T base class of the objects made
+ */
+template <typename T>
+class TXmlConfigFactory {
+public:
     /**
-     * @brief Main setup routine
-     * Loads the given XML file (or string) and maps it
-     * @param filename filename (or xml string) to load. If file the content is loaded as an xml doc
-     * @param asString false: filename is loaded and contents treated as xml doc, true: treat the string `filename` directly as an xml doc
+     * @brief the attributes of one node during book()
      */
-    void load( std::string filename, bool asString = false ) {
-        using namespace std;
+    class Definition {
+    public:
+        /**
+         * @brief the registry key of the node: its "type" attribute, or its name
+         */
+        std::string_view type() const { return mType; }
 
-        // empty the map of mNodes
-        mNodes.clear();
+        /**
+         * @brief the full canonical path of the node (allocates)
+         */
+        std::string path() const { return mNodes->key( mId ); }
 
-        // Create XML engine for parsing file
-        TXMLEngine xml;
+        /**
+         * @brief value of an attribute, dv if the node lacks it
+         */
+        std::string_view attr( std::string_view name, std::string_view dv = std::string_view() ) const {
+            for ( const auto &a : mAttrs )
+                if ( a.first == name )
+                    return a.second;
+            return dv;
+        }
 
-        // Now try to parse xml file
-        XMLDocPointer_t xmldoc;
-        if (asString)
-            xmldoc = xml.ParseString(filename.c_str());
-        else
-            xmldoc = xml.ParseFile(filename.c_str());
+        bool has( std::string_view name ) const {
+            for ( const auto &a : mAttrs )
+                if ( a.first == name )
+                    return true;
+            return false;
+        }
 
-        if (!xmldoc) { // parse failed, TODO inform of error
-            mErrorParsing = true;
-            return;
+        /**
+         * @brief an attribute converted to V, dv if the node lacks it
+         */
+        template <typename V>
+        V get( std::string_view name, V dv ) const {
+            return has( name ) ? mConfig->convertElement<V>( attr( name ) ) : dv;
         }
 
-        // access to root node (should be "config")
-        XMLNodePointer_t root_node = xml.DocGetRootElement(xmldoc);
-        // build the file map for config access
-        mapFile(xml, root_node, 1);
+        /**
+         * @brief an attribute parsed as a list of numbers, shared by every definition with the same list
+         * 
+         * @return const std::vector<double>& the list, dv if the node lacks the attribute
+         */
+        const std::vector<double> &list( std::string_view name, const std::vector<double> &dv ) const {
+            if ( !has( name ) )
+                return dv;
+            const std::string_view val = attr( name );
+            auto it = mLists->find( val );
+            if ( it == mLists->end() )
+                it = mLists->emplace( val, mConfig->parseVector<double>( val ) ).first;
+            return it->second;
+        }
 
-        // Release memory before finishing
-        xml.FreeDoc(xmldoc);
+    protected:
+        friend class TXmlConfigFactory;
+        const TXmlConfig *mConfig = nullptr;
+        const TXmlConfigStore *mNodes = nullptr;
+        uint32_t mId = 0;
+        std::string_view mType;
+        std::vector<std::pair<std::string_view, std::string_view>> mAttrs; // names without ':'
+        std::unordered_map<std::string_view, std::vector<double>> *mLists = nullptr;
+    };
+
+    using Maker = std::function<T *( const Definition & )>;
+
+    /**
+     * @brief register maker for nodes of type, replacing an earlier one
+     */
+    TXmlConfigFactory &add( std::string type, Maker maker ) {
+        mMakers[ std::move( type ) ] = std::move( maker );
+        return *this;
     }
-};
 
-// Forward declare the templates, otherwise undefined behavior in Release builds
-template <>
-std::string TXmlConfig::convert( std::string str ) const;
-template <>
-bool TXmlConfig::convert( std::string str ) const;
-template <>
-TString TXmlConfig::convert(std::string str) const;
-template <>
-std::string TXmlConfig::get( std::string path, std::string dv ) const;
-template <>
-void TXmlConfig::set( std::string path, std::string v );
-template <>
-void TXmlConfig::set( std::string path, bool bv );
+    /**
+     * @brief Make an object for every node of a registered type below path, in document order
+     * Nodes of a registered type are not descended into, other nodes are.
+     * 
+     * @param cfg config to read
+     * @param path top of the subtree, "" for the whole config
+     * @return std::vector<std::pair<std::string, T *>> node paths and the objects made, nullptr results are dropped
+     */
+    std::vector<std::pair<std::string, T *>> book( const TXmlConfig &cfg, std::string_view path ) const {
+        std::vector<std::pair<std::string, T *>> booked;
+        uint32_t top;
+        const TXmlConfigStore &nodes = cfg.resolveNode( path, top );
+        if ( top == TXmlConfigStore::npos || mMakers.empty() )
+            return booked;
+
+        std::unordered_map<std::string_view, std::vector<double>> lists;
+        Definition d;
+        d.mConfig = &cfg;
+        d.mNodes = &nodes;
+        d.mLists = &lists;
+        std::vector<uint32_t> stack;
+        auto pushChildren = [&]( uint32_t id ) {
+            // reversed so the stack pops them in document order
+            const size_t at = stack.size();
+            for ( uint32_t c = nodes.node( id ).firstChild; c != TXmlConfigStore::npos; c = nodes.node( c ).nextSibling )
+                if ( nodes.node( c ).segLen > 0 && nodes.node( c ).seg[0] != ':' )
+                    stack.push_back( c );
+            std::reverse( stack.begin() + at, stack.end() );
+        };
+        pushChildren( top );
+        while ( !stack.empty() ) {
+            const uint32_t id = stack.back();
+            stack.pop_back();
+            const TXmlConfigStore::Node &n = nodes.node( id );
+
+            d.mId = id;
+            d.mAttrs.clear();
+            d.mType = std::string_view( n.seg, n.segLen );
+            if ( !d.mType.empty() && d.mType[0] == '.' )
+                d.mType.remove_prefix( 1 );
+            for ( uint32_t c = n.firstChild; c != TXmlConfigStore::npos; c = nodes.node( c ).nextSibling ) {
+                const TXmlConfigStore::Node &a = nodes.node( c );
+                if ( a.segLen > 0 && a.seg[0] == ':' && a.val != nullptr )
+                    d.mAttrs.emplace_back( std::string_view( a.seg + 1, a.segLen - 1 ), TXmlConfigStore::value( a ) );
+            }
+            if ( d.has( "type" ) )
+                d.mType = d.attr( "type" );
+
+            auto it = mMakers.find( d.mType );
+            if ( it == mMakers.end() ) {
+                pushChildren( id );
+                continue;
+            }
+            if ( T *obj = it->second( d ) )
+                booked.emplace_back( d.path(), obj );
+        }
+        return booked;
+    }
+
+protected:
+    std::map<std::string, Maker, std::less<>> mMakers;
+};
 
 #endif
 
-#ifndef TXMLCONFIG_CXX
+#if !defined( TXMLCONFIG_CXX ) && !defined( TXMLCONFIG_DEFINITIONS )
+#define TXMLCONFIG_DEFINITIONS // once per translation unit, e.g. when TXmlConfigTree.h includes this header too
 const std::string TXmlConfig::valDNE = std::string( "<DNE/>" );
 const std::string TXmlConfig::pathDelim = std::string( "." );
 const std::string TXmlConfig::attrDelim = std::string( ":" );
-std::stringstream TXmlConfig::sstr;
+const std::string TXmlConfig::binaryExt = std::string( ".bin" );
+int TXmlConfig::precision = 0;
+std::string TXmlConfig::cacheDirectory = std::getenv( "TXMLCONFIG_CACHE" ) ? std::getenv( "TXMLCONFIG_CACHE" ) : "";
+long TXmlConfig::cacheMaxAge = 3600;
 
 ////
 // template specializations
@@ -367,10 +4538,8 @@ std::stringstream TXmlConfig::sstr;
  */
 template <>
 void TXmlConfig::set( std::string path, std::string v ) {
-
-    TXmlConfig::canonize( path );
-    // convrt from string to type T and return
-    mNodes[ path ] = v;
+    // strings are written as is
+    write( path, v );
 }
 
 /**
@@ -383,12 +4552,8 @@ void TXmlConfig::set( std::string path, std::string v ) {
 template <>
 void TXmlConfig::set( std::string path, bool bv ) {
 
-    TXmlConfig::canonize( path );
-    // convrt from string to type T and return
-    std::string v = "false";
-    if (bv)
-        v = "true";
-    mNodes[ path ] = v;
+    // convrt from bool to string and write
+    write( path, bv ? "true" : "false" );
 }
 
 // 
@@ -402,12 +4567,22 @@ void TXmlConfig::set( std::string path, bool bv ) {
  */
 template <>
 std::string TXmlConfig::get( std::string path, std::string dv ) const {
-    // return default value if path DNE
-    if ( !exists( path ) )
-        return dv;
-    TXmlConfig::canonize( path );
-    // directly return string
-    return ( mNodes.at( path ) );
+    // directly return string, or the default value if path DNE
+    return read( path, [&]( const TXmlConfig *c, uint32_t id ) { return c->valueOf<std::string>( id, dv ); } );
+}
+
+/**
+ * @brief Get a view of the value at path, without allocating
+ * The view stays valid until the next load(), compact() or the destruction of the config, set() does not invalidate it
+ * 
+ * @tparam  Specialization for std::string_view
+ * @param path path to lookup
+ * @param dv default value if path DNE
+ * @return std::string_view value at path or default
+ */
+template <>
+std::string_view TXmlConfig::get( std::string path, std::string_view dv ) const {
+    return read( path, [&]( const TXmlConfig *c, uint32_t id ) { return c->valueOf<std::string_view>( id, dv ); } );
 }
 
 /**
@@ -0,0 +1,117 @@
+#ifndef TXMLCONFIGHIST_H
+#define TXMLCONFIGHIST_H
+
+#include "TXmlConfig.h"
+#include "TH1F.h"
+#include "TH1D.h"
+#include "TH2F.h"
+#include "TH2D.h"
+#include "TProfile.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Histogram factory for TXmlConfigFactory, books every histogram of a subtree in one walk
+ * Registered types: TH1F, TH1D, TH2F, TH2D, TProfile, and Histogram (TH1F, or TH2F with bins-y).
+ * Attributes: name, title, bins-x, bins-y and for TProfile range-y="ylow, yup".
+ * A binning is "nbins, low, high" or the list of bin edges when it has more than three numbers.
+ *
+ * @code
+ * <Histograms>
+ *     <Histogram name="pt" title="p_{T};p_{T};counts" bins-x="50, 0, 10" />
+ *     <Histogram name="etaPhi" type="TH2D" bins-x="40, -2, 2" bins-y="64, -3.2, 3.2" />
+ *     <Histogram name="ptVsEta" type="TProfile" bins-x="40, -2, 2" range-y="0, 10" />
+ * </Histograms>
+ *
+ * static const TXmlConfigHistFactory histograms;
+ * for ( auto &booked : histograms.book( cfg, "Histograms" ) )
+ *     h[ booked.second->GetName() ] = booked.second;
+ * @endcode
+ */
+class TXmlConfigHistFactory : public TXmlConfigFactory<TH1> {
+public:
+    using Definition = TXmlConfigFactory<TH1>::Definition;
+
+    TXmlConfigHistFactory() {
+        add( "TH1F", []( const Definition &d ) { return make1D<TH1F>( d ); } );
+        add( "TH1D", []( const Definition &d ) { return make1D<TH1D>( d ); } );
+        add( "TH2F", []( const Definition &d ) { return make2D<TH2F>( d ); } );
+        add( "TH2D", []( const Definition &d ) { return make2D<TH2D>( d ); } );
+        add( "TProfile", []( const Definition &d ) { return makeProfile( d ); } );
+        add( "Histogram", []( const Definition &d ) -> TH1 * {
+            return d.has( "bins-y" ) ? static_cast<TH1 *>( make2D<TH2F>( d ) ) : make1D<TH1F>( d );
+        } );
+    }
+
+protected:
+    // nbins, low, high, as in the get<TH1*> example
+    static const std::vector<double> &defaultBins() {
+        static const std::vector<double> bins = { 1, 0, 1 };
+        return bins;
+    }
+
+    static const std::vector<double> &none() {
+        static const std::vector<double> empty;
+        return empty;
+    }
+
+    static bool uniform( const std::vector<double> &bins ) { return bins.size() == 3; }
+
+    // bin edges of any binning, for the constructors mixing uniform and variable axes
+    static std::vector<double> edges( const std::vector<double> &bins ) {
+        if ( !uniform( bins ) )
+            return bins;
+        const int n = static_cast<int>( bins[0] );
+        std::vector<double> e( n + 1 );
+        for ( int i = 0; i <= n; i++ )
+            e[ i ] = bins[1] + ( bins[2] - bins[1] ) * i / n;
+        return e;
+    }
+
+    static bool valid( const std::vector<double> &bins ) {
+        return uniform( bins ) ? bins[0] >= 1 : bins.size() >= 2;
+    }
+
+    template <typename H>
+    static H *make1D( const Definition &d ) {
+        const std::string name( d.attr( "name", d.type() ) );
+        const std::string title( d.attr( "title", name ) );
+        const std::vector<double> &x = d.list( "bins-x", defaultBins() );
+        if ( !valid( x ) )
+            return nullptr;
+        if ( uniform( x ) )
+            return new H( name.c_str(), title.c_str(), static_cast<int>( x[0] ), x[1], x[2] );
+        return new H( name.c_str(), title.c_str(), static_cast<int>( x.size() ) - 1, x.data() );
+    }
+
+    template <typename H>
+    static H *make2D( const Definition &d ) {
+        const std::string name( d.attr( "name", d.type() ) );
+        const std::string title( d.attr( "title", name ) );
+        const std::vector<double> &x = d.list( "bins-x", defaultBins() );
+        const std::vector<double> &y = d.list( "bins-y", defaultBins() );
+        if ( !valid( x ) || !valid( y ) )
+            return nullptr;
+        if ( uniform( x ) && uniform( y ) )
+            return new H( name.c_str(), title.c_str(), static_cast<int>( x[0] ), x[1], x[2], static_cast<int>( y[0] ), y[1], y[2] );
+        const std::vector<double> ex = edges( x ), ey = edges( y );
+        return new H( name.c_str(), title.c_str(), static_cast<int>( ex.size() ) - 1, ex.data(), static_cast<int>( ey.size() ) - 1, ey.data() );
+    }
+
+    static TProfile *makeProfile( const Definition &d ) {
+        const std::string name( d.attr( "name", d.type() ) );
+        const std::string title( d.attr( "title", name ) );
+        const std::vector<double> &x = d.list( "bins-x", defaultBins() );
+        const std::vector<double> &y = d.list( "range-y", none() );
+        if ( !valid( x ) || ( !y.empty() && y.size() != 2 ) )
+            return nullptr;
+        if ( uniform( x ) )
+            return y.empty() ? new TProfile( name.c_str(), title.c_str(), static_cast<int>( x[0] ), x[1], x[2] )
+                             : new TProfile( name.c_str(), title.c_str(), static_cast<int>( x[0] ), x[1], x[2], y[0], y[1] );
+        return y.empty() ? new TProfile( name.c_str(), title.c_str(), static_cast<int>( x.size() ) - 1, x.data() )
+                         : new TProfile( name.c_str(), title.c_str(), static_cast<int>( x.size() ) - 1, x.data(), y[0], y[1] );
+    }
+};
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef TXMLCONFIGTREE_H
+#define TXMLCONFIGTREE_H
+
+#include "TXmlConfig.h"
+#include "TTree.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+
+/**
+ * @brief Columnar copy of a repeated config node, e.g. a channel map or per module calibration
+ * Each column is an attribute (":gain") or child node (".Alignment") of the repeated node, filled for every
+ * repetition in one scan of the config. Columns are contiguous vectors, and toTree() copies the whole table
+ * into a TTree, which RDataFrame reads directly.
+ *
+ * @code
+ * TXmlConfigTable pedestals;
+ * pedestals.column<int>( "id" ).column<float>( "mean" ).column<float>( "rms", 1.0f );
+ * pedestals.fill( cfg, "Pedestals.Channel" );
+ * const std::vector<float> &mean = pedestals.get<float>( "mean" );
+ * ROOT::RDataFrame df( *pedestals.toTree( "pedestals" ) );
+ * @endcode
+ */
+class TXmlConfigTable {
+public:
+    /**
+     * @brief add a column, a name without delimiter is taken as an attribute
+     *
+     * @tparam T arithmetic type or std::string
+     * @param name attribute or child node name, also the branch name in toTree
+     * @param dv value for rows that lack it
+     */
+    template <typename T>
+    TXmlConfigTable &column( std::string name, T dv = T() ) {
+        static_assert( std::is_arithmetic<T>::value || std::is_same<T, std::string>::value,
+                       "TXmlConfigTable: columns are arithmetic types or std::string" );
+        auto c = std::make_unique<TypedColumn<T>>();
+        c->seg = ( name.empty() || ( name[0] != ':' && name[0] != '.' ) ) ? TXmlConfig::attrDelim + name : name;
+        c->name = c->seg.substr( 1 );
+        c->dv = dv;
+        mColumns.push_back( std::move( c ) );
+        return *this;
+    }
+
+    /**
+     * @brief Fill every column from the repetitions of a node, large tables are converted in parallel
+     *
+     * @param cfg config to read
+     * @param path path of the repeated node, without index
+     * @return size_t number of rows, 0 if path DNE
+     */
+    size_t fill( const TXmlConfig &cfg, std::string_view path ) {
+        std::vector<uint32_t> rows;
+        const TXmlConfigStore &nodes = cfg.tableRows( path, rows );
+        mRows = rows.size();
+        for ( auto &c : mColumns )
+            c->reset( mRows );
+
+        auto fillRows = [&]( size_t begin, size_t end ) {
+            for ( size_t r = begin; r < end; r++ ) {
+                for ( uint32_t id = nodes.node( rows[ r ] ).firstChild; id != TXmlConfigStore::npos; id = nodes.node( id ).nextSibling ) {
+                    const TXmlConfigStore::Node &n = nodes.node( id );
+                    if ( n.val == nullptr )
+                        continue;
+                    const std::string_view seg( n.seg, n.segLen );
+                    for ( auto &c : mColumns )
+                        if ( seg == c->seg )
+                            c->set( cfg, r, TXmlConfigStore::value( n ) );
+                }
+            }
+        };
+        const size_t chunk = 4096;
+        bool concurrent = true;
+        for ( auto &c : mColumns )
+            concurrent = concurrent && c->concurrent();
+        if ( mRows <= chunk || !concurrent )
+            fillRows( 0, mRows );
+        else
+            TXmlConfig::parallelFor( ( mRows + chunk - 1 ) / chunk, 0, [&]( size_t i ) { fillRows( i * chunk, std::min( mRows, ( i + 1 ) * chunk ) ); } );
+        return mRows;
+    }
+
+    size_t rows() const { return mRows; }
+
+    /**
+     * @brief the values of a column, one per row
+     * @throws std::invalid_argument if no column has this name and type
+     */
+    template <typename T>
+    const std::vector<T> &get( std::string_view name ) const {
+        for ( const auto &c : mColumns ) {
+            if ( c->name != name )
+                continue;
+            if ( auto *typed = dynamic_cast<const TypedColumn<T> *>( c.get() ) )
+                return typed->values;
+        }
+        throw std::invalid_argument( "TXmlConfigTable: no column " + std::string( name ) + " of this type" );
+    }
+
+    /**
+     * @brief Copy the table into a new TTree with one branch per column
+     * Like any new TTree it belongs to the current directory, the caller owns it otherwise.
+     *
+     * @param name tree name
+     * @param title tree title
+     * @return TTree* tree with rows() entries
+     */
+    TTree *toTree( const char *name, const char *title = "" ) const {
+        TTree *tree = new TTree( name, title );
+        for ( const auto &c : mColumns )
+            c->branch( *tree );
+        for ( size_t r = 0; r < mRows; r++ ) {
+            for ( const auto &c : mColumns )
+                c->load( r );
+            tree->Fill();
+        }
+        tree->ResetBranchAddresses(); // the buffers belong to this table
+        return tree;
+    }
+
+protected:
+    struct ColumnBase {
+        virtual ~ColumnBase() {}
+        virtual void reset( size_t rows ) = 0;
+        virtual void set( const TXmlConfig &cfg, size_t row, std::string_view value ) = 0;
+        virtual void branch( TTree &tree ) = 0;
+        virtual void load( size_t row ) = 0; // copy row into the branch buffer
+        virtual bool concurrent() const = 0; // whether rows may be set from several threads
+        std::string name; // without delimiter
+        std::string seg;  // as stored, ":gain" or ".Alignment"
+    };
+
+    template <typename T>
+    struct TypedColumn : ColumnBase {
+        void reset( size_t rows ) override { values.assign( rows, dv ); }
+        void set( const TXmlConfig &cfg, size_t row, std::string_view value ) override {
+            if constexpr ( std::is_same<T, std::string>::value )
+                values[ row ].assign( value.data(), value.size() );
+            else
+                values[ row ] = cfg.convertElement<T>( value );
+        }
+        void branch( TTree &tree ) override { tree.Branch( name.c_str(), &buffer ); }
+        void load( size_t row ) override { buffer = values[ row ]; }
+        bool concurrent() const override { return !std::is_same<T, bool>::value; } // std::vector<bool> packs bits
+
+        std::vector<T> values;
+        T dv{};
+        T buffer{};
+    };
+
+    std::vector<std::unique_ptr<ColumnBase>> mColumns;
+    size_t mRows = 0;
+};
+
+#endif